@@ -0,0 +1,199 @@
+#include <as.hpp>
+
+#include <arg.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace co = as::coro;
+
+namespace {
+
+using BenchClock = std::chrono::steady_clock;
+
+struct Result {
+    std::string name;
+    size_t count = 0;
+    size_t depth = 0;
+    double nanosecondsPerOperation = 0;
+};
+
+co::Task<> idle()
+{
+    for (;;) {
+        co_await std::suspend_always{};
+    }
+}
+
+co::Task<> nest(size_t depth)
+{
+    if (depth > 0) {
+        co_await nest(depth - 1);
+    }
+}
+
+double nanosecondsPer(BenchClock::duration duration, size_t operations)
+{
+    return std::chrono::duration<double, std::nano>(duration).count() /
+        static_cast<double>(operations);
+}
+
+BenchClock::duration measure(const std::function<void()>& action)
+{
+    auto start = BenchClock::now();
+    action();
+    return BenchClock::now() - start;
+}
+
+// Keep the number of resumes per measurement roughly constant, so that small
+// pools are measured over enough ticks and large ones do not take forever
+size_t repetitions(size_t count)
+{
+    constexpr size_t resumesPerMeasurement = 10'000'000;
+    return std::max<size_t>(1, resumesPerMeasurement / count);
+}
+
+void benchSpawn(size_t count, std::vector<Result>& results)
+{
+    auto pool = co::Pool{};
+    auto duration = measure([&pool, count] {
+        for (size_t i = 0; i < count; i++) {
+            pool << idle();
+        }
+    });
+    results.push_back(Result{
+        .name = "spawn",
+        .count = count,
+        .nanosecondsPerOperation = nanosecondsPer(duration, count),
+    });
+}
+
+void benchTick(size_t count, std::vector<Result>& results)
+{
+    auto pool = co::Pool{};
+    for (size_t i = 0; i < count; i++) {
+        pool << idle();
+    }
+    pool.tick();
+
+    const auto ticks = repetitions(count);
+    auto duration = measure([&pool, ticks] {
+        for (size_t i = 0; i < ticks; i++) {
+            pool.tick();
+        }
+    });
+    results.push_back(Result{
+        .name = "tick",
+        .count = count,
+        .nanosecondsPerOperation = nanosecondsPer(duration, count * ticks),
+    });
+}
+
+void benchClear(size_t count, std::vector<Result>& results)
+{
+    auto pool = co::Pool{};
+    for (size_t i = 0; i < count; i++) {
+        pool << idle();
+    }
+    pool.tick();
+
+    auto duration = measure([&pool] { pool.clear(); });
+    results.push_back(Result{
+        .name = "clear",
+        .count = count,
+        .nanosecondsPerOperation = nanosecondsPer(duration, count),
+    });
+}
+
+BenchClock::duration runNested(size_t count, size_t depth)
+{
+    auto pool = co::Pool{};
+    return measure([&pool, count, depth] {
+        for (size_t i = 0; i < count; i++) {
+            pool << nest(depth);
+        }
+        while (!pool.empty()) {
+            pool.tick();
+        }
+    });
+}
+
+// Each level is one subtask frame created, awaited, finished and destroyed.
+// Chains of depth 0 measure spawning and running the top-level coroutines,
+// which is taken out so that what is left is the cost of a level.
+void benchNesting(size_t count, size_t depth, std::vector<Result>& results)
+{
+    const auto baseline = runNested(count, 0);
+    const auto duration = runNested(count, depth);
+    results.push_back(Result{
+        .name = "nesting",
+        .count = count,
+        .depth = depth,
+        .nanosecondsPerOperation = nanosecondsPer(
+            std::max(duration - baseline, BenchClock::duration{}),
+            count * depth),
+    });
+}
+
+void writeJson(std::ostream& output, const std::vector<Result>& results)
+{
+    output << "{\"benchmarks\":[";
+    bool first = true;
+    for (const auto& result : results) {
+        output << (first ? "\n" : ",\n");
+        first = false;
+        output <<
+            "  {\"name\":\"" << result.name << "\"" <<
+            ",\"count\":" << result.count;
+        if (result.depth > 0) {
+            output << ",\"depth\":" << result.depth;
+        }
+        output << ",\"nsPerOp\":" << result.nanosecondsPerOperation << "}";
+    }
+    output << "\n]}\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    arg::helpKeys("-h", "--help");
+    auto maxCount = arg::option<size_t>()
+        .keys("-n", "--max-count")
+        .defaultValue(1'000'000)
+        .help("largest number of coroutines to measure");
+    auto nestingCount = arg::option<size_t>()
+        .keys("--nesting-count")
+        .defaultValue(10'000)
+        .help("number of chains in the nesting benchmark");
+    auto outputPath = arg::option<std::string>()
+        .keys("-o", "--output")
+        .metavar("PATH")
+        .help("write JSON to a file instead of standard output");
+    arg::parse(argc, argv);
+
+    auto results = std::vector<Result>{};
+    for (size_t count = 1'000; count <= *maxCount; count *= 10) {
+        benchSpawn(count, results);
+        benchTick(count, results);
+        benchClear(count, results);
+    }
+    for (size_t depth : {1, 4, 16, 64}) {
+        benchNesting(*nestingCount, depth, results);
+    }
+
+    if (outputPath.isSet()) {
+        auto output = std::ofstream{*outputPath};
+        writeJson(output, results);
+    } else {
+        writeJson(std::cout, results);
+    }
+}
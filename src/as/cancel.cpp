@@ -0,0 +1,61 @@
+#include <as/cancel.hpp>
+
+namespace as::coro {
+
+Group::~Group()
+{
+    cancel();
+}
+
+size_t Group::size() const
+{
+    return _chains.size();
+}
+
+CancellationToken Group::token() const
+{
+    return CancellationToken{_cancelled};
+}
+
+void Group::cancel()
+{
+    _cancelled->store(true, std::memory_order_relaxed);
+
+    while (!_chains.empty()) {
+        auto* root = _chains.back();
+        _chains.pop_back();
+        root->group = nullptr;
+        auto* pool = root->pool;
+        if (pool) {
+            pool->forget(*root);
+        }
+        internals::destroyChain(root);
+        if (pool) {
+            pool->unpost(root);
+        }
+    }
+}
+
+void Group::reset()
+{
+    cancel();
+    _cancelled = std::make_shared<std::atomic<bool>>(false);
+}
+
+void Group::add(PromiseBase& root)
+{
+    root.group = this;
+    root.groupSlot = _chains.size();
+    _chains.push_back(&root);
+}
+
+void Group::remove(PromiseBase& root)
+{
+    auto* last = _chains.back();
+    _chains[root.groupSlot] = last;
+    last->groupSlot = root.groupSlot;
+    _chains.pop_back();
+    root.group = nullptr;
+}
+
+} // namespace as::coro
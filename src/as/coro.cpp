@@ -1,53 +1,91 @@
 #include <as/coro.hpp>
 
+#include <as/cancel.hpp>
+#include <as/frame_allocator.hpp>
+#include <as/profiler.hpp>
+
+#include <tempo/profiler.hpp>
+
+#include <algorithm>
+#include <utility>
+
 namespace as::coro {
 
-Task Promise::get_return_object()
+void* PromiseBase::operator new(size_t size)
+{
+    return internals::allocateFrame(size);
+}
+
+void PromiseBase::operator delete(void* ptr, size_t size) noexcept
 {
-    auto handle = std::coroutine_handle<Promise>::from_promise(*this);
-    return Task{.handle = handle};
+    internals::deallocateFrame(ptr, size);
 }
 
-std::suspend_always Promise::initial_suspend()
+std::suspend_always PromiseBase::initial_suspend()
 {
     return {};
 }
 
-std::suspend_always Promise::final_suspend() noexcept
+std::suspend_always PromiseBase::final_suspend() noexcept
 {
     return {};
 }
 
-void Promise::unhandled_exception()
+void PromiseBase::unhandled_exception()
 {
     exception = std::current_exception();
 }
 
-void Promise::return_void()
+bool Sleep::await_ready() const
+{
+    return wakeTime <= Clock::now();
+}
+
+void Sleep::await_resume()
 {
 }
 
-bool Task::await_ready()
+namespace internals {
+
+void attach(PromiseBase& parent, PromiseBase& child)
 {
-    return false;
+    child.pool = parent.pool;
+    child.parent = &parent;
+    child.root = parent.root;
+    if (child.root) {
+        child.root->leaf = &child;
+    }
 }
 
-void Task::await_suspend(std::coroutine_handle<Promise> suspendedHandle) const
+bool resumeChain(PromiseBase* root)
 {
-    Pool* pool = std::coroutine_handle<Promise>::from_address(
-        suspendedHandle.address()).promise().pool;
+    for (;;) {
+        auto* leaf = root->leaf;
+        leaf->handle.resume();
+
+        if (!leaf->handle.done()) {
+            return false;
+        }
+        if (leaf == root) {
+            return true;
+        }
 
-    std::coroutine_handle<Promise>::from_address(
-        handle.address()).promise().pool = pool;
-    if (pool) {
-        pool->subtask(suspendedHandle, handle);
+        // The parent picks up the result or the exception, and destroys the
+        // finished frame with the task it awaited
+        root->leaf = leaf->parent;
     }
 }
 
-void Task::await_resume()
+void destroyChain(PromiseBase* root)
 {
+    if (root->group) {
+        root->group->remove(*root);
+    }
+    root->handle.destroy();
 }
 
+} // namespace internals
+
 Pool::~Pool()
 {
     clear();
@@ -55,74 +93,332 @@ Pool::~Pool()
 
 [[nodiscard]] bool Pool::empty() const
 {
-    return _chains.empty();
+    return idle() && _sleepers.empty() && _parked.empty();
 }
 
-Pool& Pool::operator<<(Task task)
+void Pool::tick()
 {
-    task.handle.promise().pool = this;
-    _chains.emplace_back().push(task.handle);
-    _chainByHandle.emplace(task.handle, _chains.size() - 1);
-    return *this;
+    run(Clock::time_point::max());
 }
 
-void Pool::subtask(
-    std::coroutine_handle<Promise> oldHandle,
-    std::coroutine_handle<Promise> newHandle)
+void Pool::tick(Clock::duration budget)
 {
-    auto chainIndex = _chainByHandle.at(oldHandle);
-    _chains.at(chainIndex).push(newHandle);
-    _chainByHandle.erase(oldHandle);
-    _chainByHandle.emplace(newHandle, chainIndex);
+    run(Clock::now() + budget);
 }
 
-void Pool::tick()
+void Pool::clear()
 {
-    for (size_t i = 0; i < _chains.size(); ) {
-        auto& chain = _chains.at(i);
+    // Destroying a chain may make joins forget their children, so the
+    // containers are emptied one chain at a time
+    auto containers = std::vector<std::vector<PromiseBase*>*>{
+        &_sleepers, &_parked};
+    for (auto& active : _chains) {
+        containers.push_back(&active);
+    }
 
-        chain.top().resume();
-        if (auto e = chain.top().promise().exception; e) {
-            std::rethrow_exception(e);
+    for (auto* chains : containers) {
+        while (!chains->empty()) {
+            auto* root = chains->back();
+            chains->pop_back();
+            root->state = internals::ChainState::None;
+            if (!root->join) {
+                internals::destroyChain(root);
+            }
         }
+    }
+
+    // Only once the chains are gone are their reads sure not to post them
+    auto lock = std::scoped_lock{_postMutex};
+    _posted.clear();
+}
 
-        if (chain.top().done()) {
-            _chainByHandle.erase(chain.top());
-            while (chain.top().done()) {
-                chain.top().destroy();
-                chain.pop();
-                if (chain.empty()) {
-                    break;
-                }
-                _chainByHandle.emplace(chain.top(), i);
-                chain.top().resume();
-                if (auto e = chain.top().promise().exception; e) {
-                    std::rethrow_exception(e);
-                }
+void Pool::profiler(Profiler* profiler)
+{
+    _profiler = profiler;
+}
+
+void Pool::wake(PromiseBase& root)
+{
+    root.leaf->parked = false;
+    if (root.state == internals::ChainState::Parked) {
+        remove(_parked, root);
+        activate(root);
+    }
+}
+
+void Pool::post(PromiseBase& root)
+{
+    {
+        auto lock = std::scoped_lock{_postMutex};
+        _posted.push_back(&root);
+    }
+    _postCondition.notify_one();
+}
+
+void Pool::spawnJoined(PromiseBase& root, internals::Join& join)
+{
+    root.join = &join;
+    start(root, join.waiter->priority);
+}
+
+void Pool::forget(PromiseBase& root)
+{
+    switch (root.state) {
+        case internals::ChainState::None:
+            break;
+        case internals::ChainState::Active:
+            remove(chains(root.priority), root);
+            break;
+        case internals::ChainState::Sleeping:
+            removeSleeper(root);
+            break;
+        case internals::ChainState::Parked:
+            remove(_parked, root);
+            break;
+    }
+}
+
+void Pool::unpost(const PromiseBase* root)
+{
+    auto lock = std::scoped_lock{_postMutex};
+    std::erase(_posted, root);
+}
+
+void Pool::run(Clock::time_point deadline)
+{
+    TEMPO_SCOPE("Pool::tick");
+    _tickNumber++;
+    wakePosted();
+    wakeSleepers(Clock::now());
+
+    // Chains may be added and removed while resuming, and are moved between
+    // slots when they are. Each level is therefore walked round from its
+    // cursor until a whole lap finds no chain left to resume in this tick.
+    bool resumed = false;
+    for (size_t level = 0; level < priorityCount; level++) {
+        auto& active = _chains.at(level);
+        auto& cursor = _cursors.at(level);
+
+        for (size_t misses = 0; !active.empty() && misses < active.size(); ) {
+            if (cursor >= active.size()) {
+                cursor = 0;
+            }
+
+            auto* root = active[cursor];
+            if (root->lastTick == _tickNumber) {
+                cursor++;
+                misses++;
+                continue;
+            }
+
+            if (resumed && deadline != Clock::time_point::max() &&
+                    Clock::now() >= deadline) {
+                return;
+            }
+            resumed = true;
+            misses = 0;
+
+            root->lastTick = _tickNumber;
+            resume(*root);
+
+            if (cursor < active.size() && active[cursor] == root) {
+                cursor++;
             }
         }
+    }
+}
+
+void Pool::start(PromiseBase& root, Priority priority)
+{
+    root.pool = this;
+    root.root = &root;
+    root.leaf = &root;
+    root.priority = priority;
+    activate(root);
+}
+
+void Pool::resume(PromiseBase& root)
+{
+    root.leaf->suspension = Suspension::Yield;
+    const auto start = _profiler ? Clock::now() : Clock::time_point{};
+    const bool finished = internals::resumeChain(&root);
+    if (_profiler) {
+        _profiler->resumed(root.name, start, Clock::now(),
+            finished ? Suspension::Finished : root.leaf->suspension);
+    }
 
-        if (chain.empty()) {
-            std::swap(chain, _chains.back());
-            _chains.resize(_chains.size() - 1);
-        } else {
-            _chainByHandle.emplace(chain.top(), i);
-            i++;
+    if (finished) {
+        finish(root);
+    } else if (root.leaf->wakeTime != Clock::time_point{}) {
+        remove(chains(root.priority), root);
+        pushSleeper(root);
+    } else if (root.leaf->parked) {
+        remove(chains(root.priority), root);
+        add(_parked, root, internals::ChainState::Parked);
+    }
+}
+
+void Pool::finish(PromiseBase& root)
+{
+    remove(chains(root.priority), root);
+
+    // Joined chains belong to the awaitable that started them. A failed
+    // child resumes the waiting chain right away.
+    if (auto* join = root.join) {
+        if (!join->first) {
+            join->first = &root;
+        }
+        if (join->remaining > 0 && (root.exception || --join->remaining == 0)) {
+            join->remaining = 0;
+            wake(*join->waiter);
+        }
+        return;
+    }
+
+    auto exception = root.exception;
+    internals::destroyChain(&root);
+    if (exception) {
+        try {
+            std::rethrow_exception(exception);
+        } catch (const Cancelled&) {
         }
     }
 }
 
-void Pool::clear()
+void Pool::activate(PromiseBase& root)
 {
-    _chainByHandle.clear();
-    for (auto& chain : _chains) {
-        while (!chain.empty()) {
-            if (!chain.top().done()) {
-                chain.top().destroy();
-            }
-            chain.pop();
+    add(chains(root.priority), root, internals::ChainState::Active);
+}
+
+void Pool::addToGroup(PromiseBase& root, Group& group)
+{
+    group.add(root);
+}
+
+std::vector<PromiseBase*>& Pool::chains(Priority priority)
+{
+    return _chains.at(static_cast<size_t>(priority));
+}
+
+bool Pool::idle() const
+{
+    return std::ranges::all_of(
+        _chains, [] (const auto& active) { return active.empty(); });
+}
+
+Clock::time_point Pool::nextWakeTime() const
+{
+    return _sleepers.empty() ? Clock::time_point::max() :
+        _sleepers.front()->leaf->wakeTime;
+}
+
+void Pool::wakeSleepers(Clock::time_point now)
+{
+    while (!_sleepers.empty() && _sleepers.front()->leaf->wakeTime <= now) {
+        auto* root = _sleepers.front();
+        removeSleeper(*root);
+        root->leaf->wakeTime = {};
+        activate(*root);
+    }
+}
+
+void Pool::wakePosted()
+{
+    {
+        auto lock = std::scoped_lock{_postMutex};
+        std::swap(_posted, _postedBatch);
+    }
+    for (auto* root : _postedBatch) {
+        wake(*root);
+    }
+    _postedBatch.clear();
+}
+
+void Pool::waitForWork(Clock::time_point until)
+{
+    auto lock = std::unique_lock{_postMutex};
+    _postCondition.wait_until(lock, until, [this] { return !_posted.empty(); });
+}
+
+void Pool::add(
+    std::vector<PromiseBase*>& chains,
+    PromiseBase& root,
+    internals::ChainState state)
+{
+    root.state = state;
+    root.slot = chains.size();
+    chains.push_back(&root);
+}
+
+void Pool::remove(std::vector<PromiseBase*>& chains, PromiseBase& root)
+{
+    auto* last = chains.back();
+    chains[root.slot] = last;
+    last->slot = root.slot;
+    chains.pop_back();
+    root.state = internals::ChainState::None;
+}
+
+void Pool::pushSleeper(PromiseBase& root)
+{
+    add(_sleepers, root, internals::ChainState::Sleeping);
+    siftUp(root.slot);
+}
+
+void Pool::removeSleeper(PromiseBase& root)
+{
+    auto index = root.slot;
+    auto* last = _sleepers.back();
+    _sleepers.pop_back();
+    root.state = internals::ChainState::None;
+
+    if (last != &root) {
+        placeSleeper(index, last);
+        siftUp(index);
+        siftDown(last->slot);
+    }
+}
+
+void Pool::siftUp(size_t index)
+{
+    auto* root = _sleepers[index];
+    while (index > 0) {
+        auto parent = (index - 1) / 2;
+        if (_sleepers[parent]->leaf->wakeTime <= root->leaf->wakeTime) {
+            break;
         }
+        placeSleeper(index, _sleepers[parent]);
+        index = parent;
     }
+    placeSleeper(index, root);
+}
+
+void Pool::siftDown(size_t index)
+{
+    auto* root = _sleepers[index];
+    for (;;) {
+        auto child = 2 * index + 1;
+        if (child >= _sleepers.size()) {
+            break;
+        }
+        if (child + 1 < _sleepers.size() &&
+                _sleepers[child + 1]->leaf->wakeTime <
+                    _sleepers[child]->leaf->wakeTime) {
+            child++;
+        }
+        if (root->leaf->wakeTime <= _sleepers[child]->leaf->wakeTime) {
+            break;
+        }
+        placeSleeper(index, _sleepers[child]);
+        index = child;
+    }
+    placeSleeper(index, root);
+}
+
+void Pool::placeSleeper(size_t index, PromiseBase* root)
+{
+    _sleepers[index] = root;
+    root->slot = index;
 }
 
 } // namespace as::coro
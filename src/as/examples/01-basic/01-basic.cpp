@@ -9,18 +9,13 @@ using namespace std::literals::chrono_literals;
 
 namespace co = as::coro;
 
-co::Task waitOneSecond()
+co::Task<> waitOneSecond()
 {
-    using namespace std::chrono_literals;
-    using Clock = std::chrono::high_resolution_clock;
-    const auto end = Clock::now() + 1s;
-    while (Clock::now() < end) {
-        co_await std::suspend_always{};
-    }
+    co_await co::sleep(1s);
     std::cerr << "finished waiting\n";
 }
 
-co::Task printWithWait()
+co::Task<> printWithWait()
 {
     const auto startTime = std::chrono::high_resolution_clock::now();
 
@@ -73,16 +73,7 @@ struct World {
     std::vector<Vector> trees;
 };
 
-template <class Rep, class Period>
-co::Task wait(const std::chrono::duration<Rep, Period>& duration)
-{
-    auto end = Clock::now() + duration;
-    while (Clock::now() < end) {
-        co_await std::suspend_always{};
-    }
-}
-
-co::Task moveTo(Vector& object, const Vector& target)
+co::Task<> moveTo(Vector& object, const Vector& target)
 {
     static const float distancePerSecond = 1.f;
 
@@ -105,7 +96,7 @@ co::Task moveTo(Vector& object, const Vector& target)
     object = target;
 }
 
-co::Task jump(Vector& object)
+co::Task<> jump(Vector& object)
 {
     auto initialPosition = object;
     auto start = Clock::now();
@@ -120,7 +111,7 @@ co::Task jump(Vector& object)
     object = initialPosition;
 }
 
-co::Task think(World& world)
+co::Task<> think(World& world)
 {
     while (world.trees.size() >= 2) {
         size_t t1 = 0;
@@ -157,7 +148,7 @@ co::Task think(World& world)
         co_await jump(world.eater);
         co_await jump(world.eater);
         co_await jump(world.eater);
-        co_await wait(1s);
+        co_await co::sleep(1s);
     }
 
     if (world.trees.size() == 1) {
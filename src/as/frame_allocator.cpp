@@ -0,0 +1,126 @@
+#include <as/frame_allocator.hpp>
+
+#include <array>
+#include <new>
+
+namespace as::coro {
+
+namespace {
+
+constexpr size_t granularity = 64;
+constexpr size_t classCount = 16;
+constexpr size_t maxCachedBytes = size_t{8} << 20;
+
+struct Block {
+    Block* next = nullptr;
+};
+
+// Kept trivially destructible, so that frames freed while the thread is
+// shutting down can still check whether the cache is open
+struct Cache {
+    std::array<Block*, classCount> freeLists {};
+    FrameAllocatorStats stats;
+    bool closed = false;
+};
+
+void release(Cache& cache)
+{
+    for (size_t i = 0; i < classCount; i++) {
+        while (auto* block = cache.freeLists.at(i)) {
+            cache.freeLists.at(i) = block->next;
+            ::operator delete(block, (i + 1) * granularity);
+            cache.stats.systemDeallocations++;
+        }
+    }
+    cache.stats.cachedBlocks = 0;
+    cache.stats.cachedBytes = 0;
+}
+
+struct CacheCloser {
+    explicit CacheCloser(Cache& cache) : cache(cache) {}
+    CacheCloser(const CacheCloser&) = delete;
+    CacheCloser(CacheCloser&&) = delete;
+    CacheCloser& operator=(const CacheCloser&) = delete;
+    CacheCloser& operator=(CacheCloser&&) = delete;
+
+    ~CacheCloser()
+    {
+        release(cache);
+        cache.closed = true;
+    }
+
+    Cache& cache;
+};
+
+Cache& localCache()
+{
+    thread_local Cache cache;
+    thread_local CacheCloser closer {cache};
+    return cache;
+}
+
+size_t sizeClass(size_t size)
+{
+    return (size + granularity - 1) / granularity - 1;
+}
+
+} // namespace
+
+FrameAllocatorStats frameAllocatorStats()
+{
+    return localCache().stats;
+}
+
+void trimFrameCache()
+{
+    release(localCache());
+}
+
+namespace internals {
+
+void* allocateFrame(size_t size)
+{
+    auto& cache = localCache();
+    cache.stats.allocations++;
+
+    const auto index = sizeClass(size);
+    if (index < classCount) {
+        size = (index + 1) * granularity;
+        if (auto* block = cache.freeLists.at(index)) {
+            cache.freeLists.at(index) = block->next;
+            cache.stats.cachedBlocks--;
+            cache.stats.cachedBytes -= size;
+            return block;
+        }
+    }
+
+    cache.stats.systemAllocations++;
+    return ::operator new(size);
+}
+
+void deallocateFrame(void* ptr, size_t size) noexcept
+{
+    auto& cache = localCache();
+    cache.stats.deallocations++;
+
+    const auto index = sizeClass(size);
+    if (index < classCount) {
+        const auto blockSize = (index + 1) * granularity;
+        if (!cache.closed &&
+                cache.stats.cachedBytes + blockSize <= maxCachedBytes) {
+            cache.freeLists.at(index) = new (ptr) Block{
+                .next = cache.freeLists.at(index)};
+            cache.stats.cachedBlocks++;
+            cache.stats.cachedBytes += blockSize;
+            return;
+        }
+        size = blockSize;
+    }
+
+    cache.stats.systemDeallocations++;
+    ::operator delete(ptr, size);
+}
+
+} // namespace internals
+
+} // namespace as::coro
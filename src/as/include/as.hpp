@@ -1,3 +1,10 @@
 #pragma once
 
+#include <as/cancel.hpp>
 #include <as/coro.hpp>
+#include <as/events.hpp>
+#include <as/frame_allocator.hpp>
+#include <as/io.hpp>
+#include <as/profiler.hpp>
+#include <as/threaded_pool.hpp>
+#include <as/when.hpp>
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <as/coro.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <vector>
+
+namespace as::coro {
+
+/**
+ * Thrown by CancellationToken::throwIfCancelled(). A chain that finishes
+ * with it is removed from its pool quietly, and a whenAll() or whenAny()
+ * waiting for it is resumed right away.
+ */
+class Cancelled : public std::exception {
+public:
+    [[nodiscard]] const char* what() const noexcept override
+    {
+        return "as::coro: cancelled";
+    }
+};
+
+/**
+ * Cheap copyable view of a group's cancellation state, for code that needs
+ * to notice cancellation without owning the group. It stays valid after
+ * the group is gone.
+ */
+class CancellationToken {
+public:
+    CancellationToken() = default;
+
+    [[nodiscard]] bool cancelled() const
+    {
+        return _cancelled && _cancelled->load(std::memory_order_relaxed);
+    }
+
+    void throwIfCancelled() const
+    {
+        if (cancelled()) {
+            throw Cancelled{};
+        }
+    }
+
+private:
+    explicit CancellationToken(std::shared_ptr<std::atomic<bool>> cancelled)
+        : _cancelled(std::move(cancelled))
+    { }
+
+    std::shared_ptr<std::atomic<bool>> _cancelled;
+
+    friend class Group;
+};
+
+/**
+ * Set of chains that are cancelled together, e.g. the behaviours of a level.
+ * Cancelling destroys the chains of the group, and only them, in time
+ * proportional to the group size. A group is cancelled when destroyed.
+ *
+ * Spawned chains are not handed a token; a coroutine that needs one, e.g.
+ * to stop work it passed on elsewhere, takes token() as an argument. A
+ * cancelled group stays cancelled, and its tokens with it, until reset().
+ *
+ * A chain must not cancel its own group; it can throw Cancelled instead.
+ */
+class Group {
+public:
+    Group() = default;
+
+    // Chains keep a pointer to their group
+    Group(const Group&) = delete;
+    Group(Group&&) = delete;
+    Group& operator=(const Group&) = delete;
+    Group& operator=(Group&&) = delete;
+
+    ~Group();
+
+    [[nodiscard]] size_t size() const;
+    [[nodiscard]] CancellationToken token() const;
+
+    void cancel();
+
+    /**
+     * Cancel the group, then make it usable again. Tokens taken before stay
+     * cancelled; those taken afterwards are not.
+     */
+    void reset();
+
+    void add(PromiseBase& root);
+    void remove(PromiseBase& root);
+
+private:
+    std::vector<PromiseBase*> _chains;
+    std::shared_ptr<std::atomic<bool>> _cancelled =
+        std::make_shared<std::atomic<bool>>(false);
+};
+
+} // namespace as::coro
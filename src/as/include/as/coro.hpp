@@ -1,63 +1,388 @@
 #pragma once
 
+#include <tempo/fast_clock.hpp>
+
+#include <algorithm>
+#include <array>
 #include <chrono>
+#include <condition_variable>
 #include <coroutine>
+#include <cstddef>
+#include <cstdint>
 #include <exception>
-#include <map>
-#include <stack>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace as::coro {
 
+// Read many times per tick, so a cheap clock is used
+using Clock = tempo::FastClock;
+
+/**
+ * Order in which a pool resumes chains within a tick. When a tick runs out of
+ * budget, chains of lower priority are the ones left for later ticks.
+ */
+enum class Priority : uint8_t {
+    High,
+    Normal,
+    Low,
+};
+
+inline constexpr size_t priorityCount = 3;
+
+/** Why a chain stopped running, as reported to a Profiler. */
+enum class Suspension : uint8_t {
+    Yield,
+    Sleep,
+    Join,
+    Event,
+    Io,
+    Finished,
+};
+
+inline constexpr size_t suspensionCount = 6;
+
+class Group;
 class Pool;
-struct Task;
+class Profiler;
+
+template <class T = void>
+class Task;
+
+namespace internals {
+
+struct Join;
+
+enum class ChainState : uint8_t {
+    None,
+    Active,
+    Sleeping,
+    Parked,
+};
+
+} // namespace internals
+
+/**
+ * Part of the promise that does not depend on the result type. Pools and
+ * awaitables work with coroutines through it.
+ */
+struct PromiseBase {
+    static void* operator new(size_t size);
+    static void operator delete(void* ptr, size_t size) noexcept;
 
-struct Promise {
-    Task get_return_object();
     static std::suspend_always initial_suspend();
     static std::suspend_always final_suspend() noexcept;
     void unhandled_exception();
-    static void return_void();
 
+    std::coroutine_handle<> handle;
     std::exception_ptr exception;
     Pool* pool = nullptr;
+
+    // Name for profiling, see Task::named()
+    const char* name = nullptr;
+
+    // Chain links: the coroutine awaiting this one, the top-level coroutine
+    // of the chain and, in the top-level coroutine, the innermost one
+    PromiseBase* parent = nullptr;
+    PromiseBase* root = nullptr;
+    PromiseBase* leaf = nullptr;
+
+    // Set while the coroutine sleeps, see sleep()
+    Clock::time_point wakeTime;
+
+    // Set while the coroutine waits for Pool::wake()
+    bool parked = false;
+
+    // Set by awaitables for profiling; reset before each resume
+    Suspension suspension = Suspension::Yield;
+
+    // Where the chain is kept in its pool, and when it was last resumed;
+    // only used in top-level coroutines
+    internals::ChainState state = internals::ChainState::None;
+    Priority priority = Priority::Normal;
+    size_t slot = 0;
+    uint64_t lastTick = 0;
+
+    // Set in top-level coroutines owned by whenAll() or whenAny()
+    internals::Join* join = nullptr;
+
+    // Cancellation group of a top-level coroutine, and its place there
+    Group* group = nullptr;
+    size_t groupSlot = 0;
 };
 
-struct Task {
-    using promise_type = Promise;
+template <class T>
+struct Promise : PromiseBase {
+    Task<T> get_return_object()
+    {
+        auto handle = std::coroutine_handle<Promise>::from_promise(*this);
+        this->handle = handle;
+        return Task<T>{handle};
+    }
 
-    static bool await_ready();
-    void await_suspend(std::coroutine_handle<Promise> suspendedHandle) const;
-    void await_resume();
+    void return_value(T value)
+    {
+        result.emplace(std::move(value));
+    }
 
-    std::coroutine_handle<Promise> handle;
+    std::optional<T> result;
 };
 
-class Pool {
-    using Clock = std::chrono::high_resolution_clock;
+template <>
+struct Promise<void> : PromiseBase {
+    Task<void> get_return_object();
+    static void return_void();
+};
+
+namespace internals {
+
+// Children of whenAll() or whenAny() that the waiting chain still needs
+struct Join {
+    size_t remaining = 0;
+    PromiseBase* waiter = nullptr;
+    PromiseBase* first = nullptr;
+};
 
+// Make child the innermost coroutine of the parent's chain
+void attach(PromiseBase& parent, PromiseBase& child);
+
+} // namespace internals
+
+/**
+ * Coroutine that produces a value of type T. A task owns its coroutine frame
+ * until it is given to a pool. Awaiting a task runs it as part of the
+ * awaiting chain, and yields its result or rethrows its exception.
+ */
+template <class T>
+class [[nodiscard]] Task {
+public:
+    using promise_type = Promise<T>;
+    using Handle = std::coroutine_handle<Promise<T>>;
+
+    Task() = default;
+
+    explicit Task(Handle handle)
+        : _handle(handle)
+    { }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    Task(Task&& other) noexcept
+        : _handle(std::exchange(other._handle, {}))
+    { }
+
+    Task& operator=(Task&& other) noexcept
+    {
+        if (this != &other) {
+            if (_handle) {
+                _handle.destroy();
+            }
+            _handle = std::exchange(other._handle, {});
+        }
+        return *this;
+    }
+
+    ~Task()
+    {
+        if (_handle) {
+            _handle.destroy();
+        }
+    }
+
+    static bool await_ready()
+    {
+        return false;
+    }
+
+    template <class P>
+    void await_suspend(std::coroutine_handle<P> suspendedHandle) const
+    {
+        internals::attach(suspendedHandle.promise(), _handle.promise());
+    }
+
+    T await_resume() const
+    {
+        auto& promise = _handle.promise();
+        if (promise.exception) {
+            std::rethrow_exception(promise.exception);
+        }
+        if constexpr (!std::is_void_v<T>) {
+            return std::move(*promise.result);
+        }
+    }
+
+    [[nodiscard]] Handle handle() const
+    {
+        return _handle;
+    }
+
+    /**
+     * Name the task for profiling. Statistics are collected per name of the
+     * top-level task of each chain.
+     */
+    Task named(const char* name) &&
+    {
+        _handle.promise().name = name;
+        return std::move(*this);
+    }
+
+    /** Give up ownership of the coroutine frame. */
+    Handle release()
+    {
+        return std::exchange(_handle, {});
+    }
+
+private:
+    Handle _handle;
+};
+
+inline Task<void> Promise<void>::get_return_object()
+{
+    auto handle = std::coroutine_handle<Promise>::from_promise(*this);
+    this->handle = handle;
+    return Task<void>{handle};
+}
+
+inline void Promise<void>::return_void()
+{
+}
+
+/**
+ * Awaitable that suspends a coroutine until the given time. A pool does not
+ * resume sleeping coroutines before they are due.
+ */
+struct Sleep {
+    [[nodiscard]] bool await_ready() const;
+
+    template <class P>
+    void await_suspend(std::coroutine_handle<P> suspendedHandle) const
+    {
+        suspendedHandle.promise().wakeTime = wakeTime;
+        suspendedHandle.promise().suspension = Suspension::Sleep;
+    }
+
+    static void await_resume();
+
+    Clock::time_point wakeTime;
+};
+
+inline Sleep sleepUntil(Clock::time_point wakeTime)
+{
+    return Sleep{.wakeTime = wakeTime};
+}
+
+namespace internals {
+
+// Deadline on Clock for a time point of any clock. Other clocks have no
+// common epoch with Clock, so their time points go through the time left.
+template <class C, class D>
+Clock::time_point toDeadline(const std::chrono::time_point<C, D>& end)
+{
+    if constexpr (std::is_same_v<C, Clock>) {
+        return std::chrono::time_point_cast<Clock::duration>(end);
+    } else {
+        return Clock::now() +
+            std::chrono::duration_cast<Clock::duration>(end - C::now());
+    }
+}
+
+} // namespace internals
+
+template <class Rep, class Period>
+Sleep sleep(const std::chrono::duration<Rep, Period>& duration)
+{
+    return sleepUntil(
+        Clock::now() + std::chrono::duration_cast<Clock::duration>(duration));
+}
+
+namespace internals {
+
+// Resume the innermost coroutine of a chain, and then its parents as they
+// finish. Returns true if the top-level coroutine has finished; the chain is
+// not destroyed, and its exception, if any, is left in the promise.
+bool resumeChain(PromiseBase* root);
+
+// Destroy a chain through its top-level coroutine. Frames of awaited
+// subtasks are owned by the tasks awaiting them, and go with it. The chain
+// leaves its group, if any.
+void destroyChain(PromiseBase* root);
+
+} // namespace internals
+
+class Pool {
 public:
     Pool() = default;
-    Pool(Pool&&) = default;
-    Pool& operator=(Pool&&) = default;
 
+    // Coroutines keep a pointer to their pool
     Pool(const Pool&) = delete;
-    Pool& operator=(Pool&) = delete;
+    Pool(Pool&&) = delete;
+    Pool& operator=(const Pool&) = delete;
+    Pool& operator=(Pool&&) = delete;
 
     ~Pool();
 
     [[nodiscard]] bool empty() const;
-    Pool& operator<<(Task task);
 
+    /** Start a chain. The result of the task, if any, is discarded. */
+    template <class T>
+    Pool& spawn(Task<T> task, Priority priority = Priority::Normal)
+    {
+        start(task.release().promise(), priority);
+        return *this;
+    }
+
+    /** Start a chain that is cancelled with the given group. */
+    template <class T>
+    Pool& spawn(
+        Task<T> task, Group& group, Priority priority = Priority::Normal)
+    {
+        auto& root = task.release().promise();
+        start(root, priority);
+        addToGroup(root, group);
+        return *this;
+    }
+
+    template <class T>
+    Pool& operator<<(Task<T> task)
+    {
+        return spawn(std::move(task));
+    }
+
+    /** Resume every active chain once. */
     void tick();
 
+    /**
+     * Resume active chains, in priority order, until each has been resumed
+     * once or the budget runs out. At least one chain is resumed. Chains of
+     * the same priority take turns: the next tick continues where this one
+     * stopped.
+     */
+    void tick(Clock::duration budget);
+
     void clear();
 
+    /**
+     * Collect statistics of resumed chains, or stop collecting with nullptr.
+     * The profiler must outlive its use by the pool.
+     */
+    void profiler(Profiler* profiler);
+
+    /**
+     * Tick until the given time. When no chain is active, block until the
+     * next one is due or posted instead of ticking.
+     */
     template <class C, class D>
     void runUntil(const std::chrono::time_point<C, D>& end)
     {
-        while (Clock::now() <
-                std::chrono::time_point_cast<Clock::duration>(end)) {
+        const auto deadline = internals::toDeadline(end);
+        while (Clock::now() < deadline) {
+            if (idle()) {
+                waitForWork(std::min(deadline, nextWakeTime()));
+            }
             tick();
         }
     }
@@ -69,15 +394,74 @@ public:
             std::chrono::duration_cast<Clock::duration>(duration));
     }
 
+    /*
+     * Interface for awaitables. A coroutine that sets `parked` in its promise
+     * before suspending is not resumed until wake() is called on the root of
+     * its chain.
+     */
+
+    void wake(PromiseBase& root);
+
+    // Same as wake(), but may be called from any thread. The chain is woken
+    // at the start of the next tick.
+    void post(PromiseBase& root);
+
+    // Start a chain owned by a join; see whenAll() and whenAny()
+    void spawnJoined(PromiseBase& root, internals::Join& join);
+
+    // Stop resuming a chain without destroying it
+    void forget(PromiseBase& root);
+
+    // Drop a chain from those posted for the next tick. Awaitables stop
+    // posting only when they are destroyed, so this is called after the
+    // chain that was forgotten is destroyed, not before.
+    void unpost(const PromiseBase* root);
+
 private:
-    friend struct Task;
+    static void addToGroup(PromiseBase& root, Group& group);
+
+    void run(Clock::time_point deadline);
+    void start(PromiseBase& root, Priority priority);
+    void resume(PromiseBase& root);
+    void finish(PromiseBase& root);
+    void activate(PromiseBase& root);
+
+    std::vector<PromiseBase*>& chains(Priority priority);
+    [[nodiscard]] bool idle() const;
+
+    [[nodiscard]] Clock::time_point nextWakeTime() const;
+    void wakeSleepers(Clock::time_point now);
+    void wakePosted();
+    void waitForWork(Clock::time_point until);
+
+    void add(std::vector<PromiseBase*>& chains, PromiseBase& root,
+        internals::ChainState state);
+    void remove(std::vector<PromiseBase*>& chains, PromiseBase& root);
+
+    void pushSleeper(PromiseBase& root);
+    void removeSleeper(PromiseBase& root);
+    void siftUp(size_t index);
+    void siftDown(size_t index);
+    void placeSleeper(size_t index, PromiseBase* root);
+
+    // Top-level coroutines of active chains, by priority. The rest of each
+    // chain is reachable through the links in the promises.
+    std::array<std::vector<PromiseBase*>, priorityCount> _chains;
+    std::array<size_t, priorityCount> _cursors {};
+    uint64_t _tickNumber = 0;
+    Profiler* _profiler = nullptr;
+
+    // Min-heap on the wake time of the innermost coroutine
+    std::vector<PromiseBase*> _sleepers;
 
-    void subtask(
-        std::coroutine_handle<Promise> oldHandle,
-        std::coroutine_handle<Promise> newHandle);
+    // Chains waiting for wake()
+    std::vector<PromiseBase*> _parked;
 
-    std::vector<std::stack<std::coroutine_handle<Promise>>> _chains;
-    std::map<std::coroutine_handle<Promise>, size_t> _chainByHandle;
+    // Chains passed to post(), and a batch of them being woken
+    std::mutex _postMutex;
+    std::condition_variable _postCondition;
+    std::vector<PromiseBase*> _posted;
+    std::vector<PromiseBase*> _postedBatch;
 };
 
 } // namespace as::coro
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <as/coro.hpp>
+
+#include <evening.hpp>
+
+#include <coroutine>
+#include <functional>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+namespace as::coro {
+
+/**
+ * Awaitable that parks a coroutine until a channel delivers an event of the
+ * given type, optionally one that matches a predicate. Parked coroutines are
+ * not visited by pool ticks. Only the first matching event is taken, and the
+ * channel must outlive the wait.
+ */
+template <class Event>
+class NextEvent {
+public:
+    using Predicate = std::function<bool(const Event&)>;
+
+    explicit NextEvent(evening::Channel& channel, Predicate predicate = {})
+        : _channel(channel)
+        , _predicate(std::move(predicate))
+    { }
+
+    NextEvent(const NextEvent&) = delete;
+    NextEvent(NextEvent&&) = delete;
+    NextEvent& operator=(const NextEvent&) = delete;
+    NextEvent& operator=(NextEvent&&) = delete;
+
+    ~NextEvent()
+    {
+        _channel.unsubscribe(_token);
+    }
+
+    static bool await_ready()
+    {
+        return false;
+    }
+
+    template <class P>
+    void await_suspend(std::coroutine_handle<P> suspendedHandle)
+    {
+        auto& promise = suspendedHandle.promise();
+        if (!promise.pool) {
+            throw std::logic_error{"as::coro: next() needs a Pool"};
+        }
+
+        promise.parked = true;
+        promise.suspension = Suspension::Event;
+        _token = _channel.listen<Event>(
+            [this, pool = promise.pool, root = promise.root] (
+                    const Event& event) {
+                if (_event || (_predicate && !_predicate(event))) {
+                    return;
+                }
+                _event.emplace(event);
+                _channel.unsubscribe(_token);
+                pool->wake(*root);
+            });
+    }
+
+    Event await_resume()
+    {
+        return std::move(*_event);
+    }
+
+private:
+    evening::Channel& _channel;
+    Predicate _predicate;
+    evening::Token _token;
+    std::optional<Event> _event;
+};
+
+template <class Event>
+NextEvent<Event> next(
+    evening::Channel& channel,
+    typename NextEvent<Event>::Predicate predicate = {})
+{
+    return NextEvent<Event>{channel, std::move(predicate)};
+}
+
+} // namespace as::coro
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+
+namespace as::coro {
+
+/**
+ * Counters of the calling thread's coroutine frame cache. Frames are served
+ * from per-thread free lists split into size classes, so that in steady state
+ * spawning a task does not reach the system allocator.
+ */
+struct FrameAllocatorStats {
+    size_t allocations = 0;
+    size_t deallocations = 0;
+    size_t systemAllocations = 0;
+    size_t systemDeallocations = 0;
+    size_t cachedBlocks = 0;
+    size_t cachedBytes = 0;
+};
+
+FrameAllocatorStats frameAllocatorStats();
+
+/**
+ * Return the calling thread's cached frame memory to the system.
+ */
+void trimFrameCache();
+
+namespace internals {
+
+void* allocateFrame(size_t size);
+void deallocateFrame(void* ptr, size_t size) noexcept;
+
+} // namespace internals
+
+} // namespace as::coro
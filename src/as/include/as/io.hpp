@@ -0,0 +1,131 @@
+#pragma once
+
+#include <as/coro.hpp>
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace as::io {
+
+enum class Backend : uint8_t {
+    IoUring,
+    Threads,
+};
+
+namespace internals {
+
+// A read in flight. The backend may finish it on another thread, after the
+// coroutine waiting for it is gone, so it is shared between the two.
+struct Request {
+    // Wake the waiting coroutine, if it is still there
+    void complete();
+
+    std::filesystem::path path;
+    std::vector<std::byte> data;
+    std::string error;
+
+    std::mutex mutex;
+    coro::Pool* pool = nullptr;
+    coro::PromiseBase* root = nullptr;
+};
+
+class Engine {
+public:
+    Engine() = default;
+    Engine(const Engine&) = delete;
+    Engine(Engine&&) = delete;
+    Engine& operator=(const Engine&) = delete;
+    Engine& operator=(Engine&&) = delete;
+    virtual ~Engine() = default;
+
+    virtual void submit(std::shared_ptr<Request> request) = 0;
+};
+
+} // namespace internals
+
+/**
+ * Reads files in the background. With io_uring, reads are submitted to a
+ * ring and a single thread reaps completions for all of them, so many reads
+ * can be in flight at once. Where io_uring is not available, a few threads
+ * read whole files one at a time.
+ */
+class Service {
+public:
+    static constexpr unsigned defaultRingSize = 256;
+    static constexpr size_t defaultThreadCount = 4;
+
+    explicit Service(Backend backend = Backend::IoUring);
+
+    Service(const Service&) = delete;
+    Service(Service&&) = delete;
+    Service& operator=(const Service&) = delete;
+    Service& operator=(Service&&) = delete;
+
+    ~Service();
+
+    /** Backend in use, which may differ from the requested one. */
+    [[nodiscard]] Backend backend() const;
+
+    void submit(std::shared_ptr<internals::Request> request);
+
+    /** Service used by readFile() without an explicit one. */
+    static Service& instance();
+
+private:
+    Backend _backend;
+    std::unique_ptr<internals::Engine> _engine;
+};
+
+/**
+ * Awaitable that reads a whole file without blocking the pool. The awaiting
+ * coroutine is parked until the read is complete.
+ */
+class ReadFile {
+public:
+    ReadFile(Service& service, std::filesystem::path path);
+
+    ReadFile(const ReadFile&) = delete;
+    ReadFile(ReadFile&&) = delete;
+    ReadFile& operator=(const ReadFile&) = delete;
+    ReadFile& operator=(ReadFile&&) = delete;
+
+    ~ReadFile();
+
+    static bool await_ready()
+    {
+        return false;
+    }
+
+    template <class P>
+    void await_suspend(std::coroutine_handle<P> suspendedHandle)
+    {
+        suspend(suspendedHandle.promise());
+    }
+
+    std::vector<std::byte> await_resume();
+
+private:
+    void suspend(coro::PromiseBase& promise);
+
+    Service& _service;
+    std::shared_ptr<internals::Request> _request;
+};
+
+inline ReadFile readFile(Service& service, std::filesystem::path path)
+{
+    return ReadFile{service, std::move(path)};
+}
+
+inline ReadFile readFile(std::filesystem::path path)
+{
+    return ReadFile{Service::instance(), std::move(path)};
+}
+
+} // namespace as::io
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <as/coro.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace as::coro {
+
+const char* suspensionName(Suspension suspension);
+
+/**
+ * Statistics of chains resumed by a pool, collected while the profiler is
+ * set with Pool::profiler(). Chains are grouped by the name of their
+ * top-level task. Counters accumulate until reset().
+ */
+class Profiler {
+public:
+    struct TaskStats {
+        std::string name;
+        uint64_t resumes = 0;
+        Clock::duration runTime{};
+        std::array<uint64_t, suspensionCount> suspensions{};
+    };
+
+    struct Span {
+        const TaskStats* task = nullptr;
+        Clock::time_point start;
+        Clock::duration duration{};
+        Suspension suspension = Suspension::Yield;
+    };
+
+    void resumed(
+        const char* name,
+        Clock::time_point start,
+        Clock::time_point end,
+        Suspension suspension);
+
+    /**
+     * Limit the number of resume spans kept for the Chrome trace. Counters
+     * are not affected by the limit.
+     */
+    void spanLimit(size_t limit);
+
+    [[nodiscard]] const std::map<std::string, TaskStats, std::less<>>&
+        tasks() const;
+    [[nodiscard]] const std::vector<Span>& spans() const;
+
+    void reset();
+
+    /**
+     * Write the kept resume spans as a Chrome trace, one event per resume,
+     * named after the task and tagged with how the chain suspended.
+     */
+    void writeChromeTrace(std::ostream& output) const;
+
+private:
+    std::map<std::string, TaskStats, std::less<>> _tasks;
+    std::vector<Span> _spans;
+    size_t _spanLimit = size_t{1} << 16;
+    Clock::time_point _start = Clock::now();
+};
+
+} // namespace as::coro
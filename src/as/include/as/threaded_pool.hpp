@@ -0,0 +1,125 @@
+#pragma once
+
+#include <as/coro.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace as::coro {
+
+/**
+ * Pool that resumes its chains on several threads. Each tick, active chains
+ * are split between per-worker deques, and workers that run out of work
+ * steal from the others. The calling thread works too, and tick() returns
+ * only when every active chain has been resumed. Sleeping chains wait in a
+ * heap until they are due, as in Pool.
+ *
+ * Finished chains are destroyed on the calling thread, so their frames go
+ * back to its frame cache. Frames of awaited subtasks are allocated and
+ * freed by whichever workers resume them, so they may move from the cache
+ * of one worker to that of another.
+ *
+ * Coroutines in a threaded pool must not touch shared state without
+ * synchronization, and must not add tasks to the pool they run in. Awaitables
+ * that need Pool, such as whenAll(), are not supported.
+ */
+class ThreadedPool {
+public:
+    explicit ThreadedPool(
+        size_t threadCount = std::thread::hardware_concurrency());
+
+    ThreadedPool(const ThreadedPool&) = delete;
+    ThreadedPool(ThreadedPool&&) = delete;
+    ThreadedPool& operator=(const ThreadedPool&) = delete;
+    ThreadedPool& operator=(ThreadedPool&&) = delete;
+
+    ~ThreadedPool();
+
+    [[nodiscard]] bool empty() const;
+    [[nodiscard]] size_t threadCount() const;
+
+    template <class T>
+    ThreadedPool& operator<<(Task<T> task)
+    {
+        spawn(task.release().promise());
+        return *this;
+    }
+
+    void tick();
+
+    void clear();
+
+    /**
+     * Tick until the given time. When no chain is active, sleep until the
+     * next one is due instead of ticking.
+     */
+    template <class C, class D>
+    void runUntil(const std::chrono::time_point<C, D>& end)
+    {
+        const auto deadline = internals::toDeadline(end);
+        while (Clock::now() < deadline) {
+            if (_chains.empty()) {
+                waitForWork(std::min(deadline, nextWakeTime()));
+            }
+            tick();
+        }
+    }
+
+    template <class Rep, class Period>
+    void runFor(const std::chrono::duration<Rep, Period>& duration)
+    {
+        runUntil(Clock::now() +
+            std::chrono::duration_cast<Clock::duration>(duration));
+    }
+
+private:
+    enum class StepResult : uint8_t {
+        Yielded,
+        Slept,
+        Finished,
+    };
+
+    struct Worker {
+        std::mutex mutex;
+        std::deque<size_t> chains;
+        std::vector<size_t> finished;
+        std::vector<size_t> slept;
+        std::thread thread;
+    };
+
+    void spawn(PromiseBase& root);
+    void work(size_t workerIndex);
+    void drain(size_t workerIndex);
+    bool pop(size_t workerIndex, size_t& chainIndex);
+    bool steal(size_t workerIndex, size_t& chainIndex);
+    StepResult step(size_t chainIndex);
+    void retire();
+
+    [[nodiscard]] Clock::time_point nextWakeTime() const;
+    void wakeSleepers(Clock::time_point now);
+    static void waitForWork(Clock::time_point until);
+
+    // Top-level coroutines of active chains
+    std::vector<PromiseBase*> _chains;
+    // Min-heap on the wake time of the innermost coroutine
+    std::vector<PromiseBase*> _sleepers;
+    std::vector<PromiseBase*> _finished;
+    std::vector<std::unique_ptr<Worker>> _workers;
+
+    std::mutex _mutex;
+    std::condition_variable _tickStarted;
+    std::condition_variable _tickFinished;
+    uint64_t _tickNumber = 0;
+    size_t _busyWorkers = 0;
+    bool _stop = false;
+};
+
+} // namespace as::coro
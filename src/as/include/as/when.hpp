@@ -0,0 +1,291 @@
+#pragma once
+
+#include <as/coro.hpp>
+
+#include <concepts>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace as::coro {
+
+/** Result of awaiting whenAll() for a task of type T. */
+template <class T>
+using Result = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+/** Result of awaiting whenAny(): the index of the first task and its value. */
+template <class T>
+struct AnyResult {
+    size_t index = 0;
+    T value;
+};
+
+namespace internals {
+
+// Park the waiting chain until the join is complete
+inline Pool& startJoin(PromiseBase& waiting, Join& join, size_t remaining)
+{
+    if (!waiting.pool) {
+        throw std::logic_error{"as::coro: whenAll and whenAny need a Pool"};
+    }
+    join.remaining = remaining;
+    join.waiter = waiting.root;
+    waiting.parked = true;
+    waiting.suspension = Suspension::Join;
+    return *waiting.pool;
+}
+
+template <class T>
+void spawnJoined(Pool& pool, Task<T>& task, Join& join)
+{
+    pool.spawnJoined(task.handle().promise(), join);
+}
+
+// Stop a child that is still running, and destroy its frame
+template <class T>
+void forgetJoined(Task<T>& task)
+{
+    auto* promise = &task.handle().promise();
+    auto* pool = promise->pool;
+    if (pool) {
+        pool->forget(*promise);
+    }
+    task = Task<T>{};
+    if (pool) {
+        pool->unpost(promise);
+    }
+}
+
+template <class T>
+void rethrowIfFailed(Task<T>& task)
+{
+    if (auto e = task.handle().promise().exception; e) {
+        std::rethrow_exception(e);
+    }
+}
+
+template <class T>
+Result<T> takeResult(Task<T>& task)
+{
+    if constexpr (std::is_void_v<T>) {
+        return {};
+    } else {
+        return std::move(*task.handle().promise().result);
+    }
+}
+
+} // namespace internals
+
+/**
+ * Awaitable that runs tasks as separate chains of the awaiting coroutine's
+ * pool, and resumes it when all of them have finished. If a task throws, the
+ * others are stopped and the exception is rethrown.
+ */
+template <class... Ts>
+class WhenAll {
+public:
+    explicit WhenAll(Task<Ts>... tasks)
+        : _tasks(std::move(tasks)...)
+    { }
+
+    WhenAll(const WhenAll&) = delete;
+    WhenAll(WhenAll&&) = delete;
+    WhenAll& operator=(const WhenAll&) = delete;
+    WhenAll& operator=(WhenAll&&) = delete;
+
+    ~WhenAll()
+    {
+        std::apply([] (auto&... tasks) {
+            (internals::forgetJoined(tasks), ...);
+        }, _tasks);
+    }
+
+    static bool await_ready()
+    {
+        return sizeof...(Ts) == 0;
+    }
+
+    template <class P>
+    void await_suspend(std::coroutine_handle<P> suspendedHandle)
+    {
+        auto& pool = internals::startJoin(
+            suspendedHandle.promise(), _join, sizeof...(Ts));
+        std::apply([this, &pool] (auto&... tasks) {
+            (internals::spawnJoined(pool, tasks, _join), ...);
+        }, _tasks);
+    }
+
+    std::tuple<Result<Ts>...> await_resume()
+    {
+        return std::apply([] (auto&... tasks) {
+            (internals::rethrowIfFailed(tasks), ...);
+            return std::tuple<Result<Ts>...>{internals::takeResult(tasks)...};
+        }, _tasks);
+    }
+
+private:
+    std::tuple<Task<Ts>...> _tasks;
+    internals::Join _join;
+};
+
+/**
+ * Same as WhenAll, for any number of tasks of the same type.
+ */
+template <class T>
+class WhenAllRange {
+public:
+    explicit WhenAllRange(std::vector<Task<T>> tasks)
+        : _tasks(std::move(tasks))
+    { }
+
+    WhenAllRange(const WhenAllRange&) = delete;
+    WhenAllRange(WhenAllRange&&) = delete;
+    WhenAllRange& operator=(const WhenAllRange&) = delete;
+    WhenAllRange& operator=(WhenAllRange&&) = delete;
+
+    ~WhenAllRange()
+    {
+        for (auto& task : _tasks) {
+            internals::forgetJoined(task);
+        }
+    }
+
+    [[nodiscard]] bool await_ready() const
+    {
+        return _tasks.empty();
+    }
+
+    template <class P>
+    void await_suspend(std::coroutine_handle<P> suspendedHandle)
+    {
+        auto& pool = internals::startJoin(
+            suspendedHandle.promise(), _join, _tasks.size());
+        for (auto& task : _tasks) {
+            internals::spawnJoined(pool, task, _join);
+        }
+    }
+
+    auto await_resume()
+    {
+        for (auto& task : _tasks) {
+            internals::rethrowIfFailed(task);
+        }
+
+        if constexpr (!std::is_void_v<T>) {
+            auto results = std::vector<T>{};
+            results.reserve(_tasks.size());
+            for (auto& task : _tasks) {
+                results.push_back(internals::takeResult(task));
+            }
+            return results;
+        }
+    }
+
+private:
+    std::vector<Task<T>> _tasks;
+    internals::Join _join;
+};
+
+/**
+ * Awaitable that runs tasks as separate chains of the awaiting coroutine's
+ * pool, and resumes it when the first of them finishes. The others are
+ * stopped. Awaiting yields the index of the first task, and its value for
+ * non-void tasks.
+ */
+template <class T>
+class WhenAny {
+public:
+    explicit WhenAny(std::vector<Task<T>> tasks)
+        : _tasks(std::move(tasks))
+    {
+        if (_tasks.empty()) {
+            throw std::invalid_argument{"as::coro: whenAny needs a task"};
+        }
+    }
+
+    WhenAny(const WhenAny&) = delete;
+    WhenAny(WhenAny&&) = delete;
+    WhenAny& operator=(const WhenAny&) = delete;
+    WhenAny& operator=(WhenAny&&) = delete;
+
+    ~WhenAny()
+    {
+        for (auto& task : _tasks) {
+            internals::forgetJoined(task);
+        }
+    }
+
+    static bool await_ready()
+    {
+        return false;
+    }
+
+    template <class P>
+    void await_suspend(std::coroutine_handle<P> suspendedHandle)
+    {
+        auto& pool = internals::startJoin(suspendedHandle.promise(), _join, 1);
+        for (auto& task : _tasks) {
+            internals::spawnJoined(pool, task, _join);
+        }
+    }
+
+    auto await_resume()
+    {
+        size_t index = 0;
+        while (&_tasks.at(index).handle().promise() != _join.first) {
+            index++;
+        }
+
+        auto& task = _tasks.at(index);
+        internals::rethrowIfFailed(task);
+        if constexpr (std::is_void_v<T>) {
+            return index;
+        } else {
+            return AnyResult<T>{
+                .index = index,
+                .value = internals::takeResult(task),
+            };
+        }
+    }
+
+private:
+    std::vector<Task<T>> _tasks;
+    internals::Join _join;
+};
+
+template <class... Ts>
+WhenAll<Ts...> whenAll(Task<Ts>... tasks)
+{
+    return WhenAll<Ts...>{std::move(tasks)...};
+}
+
+template <class T>
+WhenAllRange<T> whenAll(std::vector<Task<T>> tasks)
+{
+    return WhenAllRange<T>{std::move(tasks)};
+}
+
+template <class T>
+WhenAny<T> whenAny(std::vector<Task<T>> tasks)
+{
+    return WhenAny<T>{std::move(tasks)};
+}
+
+template <class T, class... Rest>
+requires (std::same_as<Rest, Task<T>> && ...)
+WhenAny<T> whenAny(Task<T> first, Rest... rest)
+{
+    auto tasks = std::vector<Task<T>>{};
+    tasks.reserve(1 + sizeof...(Rest));
+    tasks.push_back(std::move(first));
+    (tasks.push_back(std::move(rest)), ...);
+    return WhenAny<T>{std::move(tasks)};
+}
+
+} // namespace as::coro
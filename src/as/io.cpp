@@ -0,0 +1,571 @@
+#include <as/io.hpp>
+
+#include <fi/fs.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace as::io {
+
+namespace internals {
+
+void Request::complete()
+{
+    auto lock = std::scoped_lock{mutex};
+    if (pool) {
+        pool->post(*root);
+    }
+}
+
+namespace {
+
+class ThreadEngine : public Engine {
+public:
+    explicit ThreadEngine(size_t threadCount)
+    {
+        for (size_t i = 0; i < threadCount; i++) {
+            _threads.emplace_back(&ThreadEngine::work, this);
+        }
+    }
+
+    ThreadEngine(const ThreadEngine&) = delete;
+    ThreadEngine(ThreadEngine&&) = delete;
+    ThreadEngine& operator=(const ThreadEngine&) = delete;
+    ThreadEngine& operator=(ThreadEngine&&) = delete;
+
+    ~ThreadEngine() override
+    {
+        {
+            auto lock = std::scoped_lock{_mutex};
+            _stop = true;
+        }
+        _condition.notify_all();
+        for (auto& thread : _threads) {
+            thread.join();
+        }
+    }
+
+    void submit(std::shared_ptr<Request> request) override
+    {
+        {
+            auto lock = std::scoped_lock{_mutex};
+            _queue.push_back(std::move(request));
+        }
+        _condition.notify_one();
+    }
+
+private:
+    void work()
+    {
+        for (;;) {
+            auto request = std::shared_ptr<Request>{};
+            {
+                auto lock = std::unique_lock{_mutex};
+                _condition.wait(lock, [this] {
+                    return _stop || !_queue.empty();
+                });
+                if (_queue.empty()) {
+                    return;
+                }
+                request = std::move(_queue.front());
+                _queue.pop_front();
+            }
+
+            try {
+                request->data = fi::read<std::byte>(request->path);
+            } catch (const std::exception& e) {
+                request->error = e.what();
+            }
+            request->complete();
+        }
+    }
+
+    std::vector<std::thread> _threads;
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    std::deque<std::shared_ptr<Request>> _queue;
+    bool _stop = false;
+};
+
+#ifdef __linux__
+
+/*
+ * io_uring through raw system calls, so that liburing is not needed. Each
+ * file is opened, sized and read by operations on the ring, so submitting
+ * never blocks; one thread waits for completions, submits the next step of
+ * each file in one batch, resubmits short reads and wakes the waiting
+ * coroutines. Operations beyond the ring size wait in a backlog.
+ */
+class UringEngine : public Engine {
+public:
+    // Returns null where io_uring or the operations used are not available
+    static std::unique_ptr<UringEngine> create(unsigned entries)
+    {
+        auto params = io_uring_params{};
+        int fd = static_cast<int>(
+            syscall(__NR_io_uring_setup, entries, &params));
+        if (fd < 0) {
+            return nullptr;
+        }
+
+        auto rings = Rings{};
+        if (!supported(fd) || !map(fd, params, rings)) {
+            close(fd);
+            return nullptr;
+        }
+        try {
+            return std::unique_ptr<UringEngine>{
+                new UringEngine{fd, params, rings}};
+        } catch (const std::system_error&) {
+            unmap(rings);
+            close(fd);
+            return nullptr;
+        }
+    }
+
+    UringEngine(const UringEngine&) = delete;
+    UringEngine(UringEngine&&) = delete;
+    UringEngine& operator=(const UringEngine&) = delete;
+    UringEngine& operator=(UringEngine&&) = delete;
+
+    ~UringEngine() override
+    {
+        {
+            auto lock = std::scoped_lock{_submitMutex};
+            auto stop = io_uring_sqe{};
+            stop.opcode = IORING_OP_NOP;
+            stop.user_data = 0;
+            queue(stop);
+            enter();
+        }
+        _reaper.join();
+
+        unmap(_rings);
+        close(_fd);
+    }
+
+    void submit(std::shared_ptr<Request> request) override
+    {
+        auto lock = std::scoped_lock{_submitMutex};
+        start(new Read{.request = std::move(request)});
+        enter();
+    }
+
+private:
+    struct Rings {
+        void* sq = nullptr;
+        void* cq = nullptr;
+        io_uring_sqe* sqes = nullptr;
+        size_t sqSize = 0;
+        size_t cqSize = 0;
+        size_t sqesSize = 0;
+    };
+
+    enum class Step : uint8_t {
+        Open,
+        Stat,
+        Read,
+    };
+
+    struct Read {
+        std::shared_ptr<Request> request;
+        Step step = Step::Open;
+        int fd = -1;
+        struct statx status {};
+        size_t offset = 0;
+    };
+
+    UringEngine(int fd, const io_uring_params& params, const Rings& rings)
+        : _fd(fd)
+        , _sqEntries(params.sq_entries)
+        , _rings(rings)
+    {
+        auto* sq = static_cast<std::byte*>(_rings.sq);
+        _sqHead = reinterpret_cast<uint32_t*>(sq + params.sq_off.head);
+        _sqTail = reinterpret_cast<uint32_t*>(sq + params.sq_off.tail);
+        _sqMask = *reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+        _sqArray = reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+
+        auto* cq = static_cast<std::byte*>(_rings.cq);
+        _cqHead = reinterpret_cast<uint32_t*>(cq + params.cq_off.head);
+        _cqTail = reinterpret_cast<uint32_t*>(cq + params.cq_off.tail);
+        _cqMask = *reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+        _cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+        _reaper = std::thread{&UringEngine::reap, this};
+    }
+
+    static bool supported(int fd)
+    {
+        constexpr unsigned opCount = 256;
+        alignas(io_uring_probe) std::array<std::byte,
+            sizeof(io_uring_probe) + opCount * sizeof(io_uring_probe_op)>
+                buffer {};
+        auto* probe = reinterpret_cast<io_uring_probe*>(buffer.data());
+        if (syscall(__NR_io_uring_register,
+                fd, IORING_REGISTER_PROBE, probe, opCount) < 0) {
+            return false;
+        }
+
+        return std::ranges::all_of(
+            std::array{IORING_OP_OPENAT, IORING_OP_STATX, IORING_OP_READ},
+            [probe] (auto op) {
+                return op < probe->ops_len &&
+                    (probe->ops[op].flags & IO_URING_OP_SUPPORTED) != 0;
+            });
+    }
+
+    // Map the rings, or unmap what was mapped and return false
+    static bool map(int fd, const io_uring_params& params, Rings& rings)
+    {
+        auto mapOne = [fd] (size_t size, uint64_t offset) -> void* {
+            void* address = mmap(
+                nullptr, size, PROT_READ | PROT_WRITE,
+                MAP_SHARED | MAP_POPULATE, fd, static_cast<off_t>(offset));
+            return address == MAP_FAILED ? nullptr : address;
+        };
+
+        rings.sqSize =
+            params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+        rings.cqSize =
+            params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (singleMap) {
+            rings.sqSize = rings.cqSize = std::max(rings.sqSize, rings.cqSize);
+        }
+        rings.sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+
+        rings.sq = mapOne(rings.sqSize, IORING_OFF_SQ_RING);
+        if (rings.sq) {
+            rings.cq = singleMap ?
+                rings.sq : mapOne(rings.cqSize, IORING_OFF_CQ_RING);
+        }
+        if (rings.cq) {
+            rings.sqes = static_cast<io_uring_sqe*>(
+                mapOne(rings.sqesSize, IORING_OFF_SQES));
+        }
+        if (!rings.sqes) {
+            unmap(rings);
+            return false;
+        }
+        return true;
+    }
+
+    static void unmap(const Rings& rings)
+    {
+        if (rings.sqes) {
+            munmap(rings.sqes, rings.sqesSize);
+        }
+        if (rings.cq && rings.cq != rings.sq) {
+            munmap(rings.cq, rings.cqSize);
+        }
+        if (rings.sq) {
+            munmap(rings.sq, rings.sqSize);
+        }
+    }
+
+    // Called with _submitMutex held
+    void start(Read* read)
+    {
+        if (_inFlight == _sqEntries) {
+            _backlog.push_back(read);
+            return;
+        }
+
+        auto& request = *read->request;
+        auto sqe = io_uring_sqe{};
+        switch (read->step) {
+            case Step::Open:
+                sqe.opcode = IORING_OP_OPENAT;
+                sqe.fd = AT_FDCWD;
+                sqe.addr = reinterpret_cast<uint64_t>(request.path.c_str());
+                sqe.open_flags = O_RDONLY | O_CLOEXEC;
+                break;
+            case Step::Stat:
+                sqe.opcode = IORING_OP_STATX;
+                sqe.fd = read->fd;
+                sqe.addr = reinterpret_cast<uint64_t>("");
+                sqe.len = STATX_SIZE;
+                sqe.addr2 = reinterpret_cast<uint64_t>(&read->status);
+                sqe.statx_flags = AT_EMPTY_PATH;
+                break;
+            case Step::Read:
+                sqe.opcode = IORING_OP_READ;
+                sqe.fd = read->fd;
+                sqe.off = read->offset;
+                sqe.addr = reinterpret_cast<uint64_t>(
+                    request.data.data() + read->offset);
+                sqe.len = static_cast<uint32_t>(std::min<size_t>(
+                    request.data.size() - read->offset, 1U << 30U));
+                break;
+        }
+        sqe.user_data = reinterpret_cast<uint64_t>(read);
+        queue(sqe);
+        _inFlight++;
+    }
+
+    // Called with _submitMutex held. The entry is submitted by enter().
+    void queue(const io_uring_sqe& sqe)
+    {
+        auto tail = *_sqTail;
+        auto index = tail & _sqMask;
+        _rings.sqes[index] = sqe;
+        _sqArray[index] = index;
+        std::atomic_ref{*_sqTail}.store(tail + 1, std::memory_order_release);
+    }
+
+    // Called with _submitMutex held. Submit all queued entries with as few
+    // system calls as the kernel allows. Reads whose entries it refuses fail,
+    // rather than waiting for completions that never come.
+    void enter()
+    {
+        for (;;) {
+            const auto tail = *_sqTail;
+            const auto head =
+                std::atomic_ref{*_sqHead}.load(std::memory_order_acquire);
+            if (head == tail) {
+                return;
+            }
+
+            const auto submitted = syscall(
+                __NR_io_uring_enter, _fd, tail - head, 0, 0, nullptr, 0);
+            if (submitted > 0 || (submitted < 0 && errno == EINTR)) {
+                continue;
+            }
+            refuse(head, tail, submitted < 0 ? errno : EAGAIN);
+            startBacklog();
+        }
+    }
+
+    // Take back the entries the kernel did not consume, and fail their reads
+    void refuse(uint32_t head, uint32_t tail, int error)
+    {
+        for (auto i = head; i != tail; i++) {
+            const auto& sqe = _rings.sqes[_sqArray[i & _sqMask]];
+            if (sqe.user_data == 0) {
+                continue;
+            }
+            auto* read = reinterpret_cast<Read*>(sqe.user_data); // NOLINT
+            read->request->error = "as::io: cannot submit read: " +
+                read->request->path.string() + ": " + std::strerror(error);
+            _inFlight--;
+            complete(read);
+        }
+        std::atomic_ref{*_sqTail}.store(head, std::memory_order_release);
+    }
+
+    void reap()
+    {
+        for (;;) {
+            auto head = *_cqHead;
+            auto tail =
+                std::atomic_ref{*_cqTail}.load(std::memory_order_acquire);
+            if (head == tail) {
+                syscall(__NR_io_uring_enter, _fd, 0, 1,
+                    IORING_ENTER_GETEVENTS, nullptr, 0);
+                continue;
+            }
+
+            auto lock = std::scoped_lock{_submitMutex};
+            bool stop = false;
+            for (; head != tail; head++) {
+                const auto& cqe = _cqes[head & _cqMask];
+                if (cqe.user_data == 0) {
+                    stop = true;
+                } else {
+                    finish(
+                        reinterpret_cast<Read*>(cqe.user_data), // NOLINT
+                        cqe.res);
+                }
+            }
+            std::atomic_ref{*_cqHead}.store(head, std::memory_order_release);
+            startBacklog();
+            enter();
+
+            if (stop) {
+                _stopSeen = true;
+            }
+            if (_stopSeen && _inFlight == 0 && _backlog.empty()) {
+                return;
+            }
+        }
+    }
+
+    // Called with _submitMutex held
+    void finish(Read* read, int result)
+    {
+        _inFlight--;
+        if (advance(*read, result)) {
+            start(read);
+        } else {
+            complete(read);
+        }
+    }
+
+    // Called with _submitMutex held
+    void startBacklog()
+    {
+        while (!_backlog.empty() && _inFlight < _sqEntries) {
+            auto* next = _backlog.front();
+            _backlog.pop_front();
+            start(next);
+        }
+    }
+
+    static void complete(Read* read)
+    {
+        if (read->fd >= 0) {
+            close(read->fd);
+        }
+        read->request->complete();
+        delete read;
+    }
+
+    // Take the result of the last step, and return whether there is another
+    static bool advance(Read& read, int result)
+    {
+        auto& request = *read.request;
+        if (result < 0) {
+            request.error =
+                std::string{read.step == Step::Read ?
+                    "as::io: cannot read file: " :
+                    "as::io: cannot open file: "} +
+                request.path.string() + ": " + std::strerror(-result);
+            return false;
+        }
+
+        switch (read.step) {
+            case Step::Open:
+                read.fd = result;
+                read.step = Step::Stat;
+                return true;
+            case Step::Stat:
+                request.data.resize(static_cast<size_t>(read.status.stx_size));
+                read.step = Step::Read;
+                return !request.data.empty();
+            case Step::Read:
+                if (result == 0) {
+                    // The file got shorter since it was opened
+                    request.data.resize(read.offset);
+                    return false;
+                }
+                read.offset += static_cast<size_t>(result);
+                return read.offset < request.data.size();
+        }
+        return false;
+    }
+
+    int _fd = -1;
+    unsigned _sqEntries = 0;
+    Rings _rings;
+
+    uint32_t* _sqHead = nullptr;
+    uint32_t* _sqTail = nullptr;
+    uint32_t _sqMask = 0;
+    uint32_t* _sqArray = nullptr;
+    uint32_t* _cqHead = nullptr;
+    uint32_t* _cqTail = nullptr;
+    uint32_t _cqMask = 0;
+    io_uring_cqe* _cqes = nullptr;
+
+    std::mutex _submitMutex;
+    unsigned _inFlight = 0;
+    std::deque<Read*> _backlog;
+    bool _stopSeen = false;
+    std::thread _reaper;
+};
+
+#endif
+
+} // namespace
+
+} // namespace internals
+
+Service::Service(Backend backend)
+    : _backend(backend)
+{
+#ifdef __linux__
+    if (backend == Backend::IoUring) {
+        _engine = internals::UringEngine::create(defaultRingSize);
+    }
+#endif
+    if (!_engine) {
+        _backend = Backend::Threads;
+        _engine = std::make_unique<internals::ThreadEngine>(defaultThreadCount);
+    }
+}
+
+Service::~Service() = default;
+
+Backend Service::backend() const
+{
+    return _backend;
+}
+
+void Service::submit(std::shared_ptr<internals::Request> request)
+{
+    _engine->submit(std::move(request));
+}
+
+Service& Service::instance()
+{
+    static auto service = Service{};
+    return service;
+}
+
+ReadFile::ReadFile(Service& service, std::filesystem::path path)
+    : _service(service)
+    , _request(std::make_shared<internals::Request>())
+{
+    _request->path = std::move(path);
+}
+
+ReadFile::~ReadFile()
+{
+    auto lock = std::scoped_lock{_request->mutex};
+    _request->pool = nullptr;
+}
+
+std::vector<std::byte> ReadFile::await_resume()
+{
+    if (!_request->error.empty()) {
+        throw std::runtime_error{_request->error};
+    }
+    return std::move(_request->data);
+}
+
+void ReadFile::suspend(coro::PromiseBase& promise)
+{
+    if (!promise.pool) {
+        throw std::logic_error{"as::io: readFile needs a Pool"};
+    }
+
+    {
+        auto lock = std::scoped_lock{_request->mutex};
+        _request->pool = promise.pool;
+        _request->root = promise.root;
+    }
+    promise.parked = true;
+    promise.suspension = coro::Suspension::Io;
+    _service.submit(_request);
+}
+
+} // namespace as::io
@@ -0,0 +1,95 @@
+#include <as/profiler.hpp>
+
+#include <tempo/chrome_trace.hpp>
+
+#include <string_view>
+
+namespace as::coro {
+
+namespace {
+
+constexpr std::string_view unnamed = "<unnamed>";
+
+} // namespace
+
+const char* suspensionName(Suspension suspension)
+{
+    switch (suspension) {
+        case Suspension::Yield: return "yield";
+        case Suspension::Sleep: return "sleep";
+        case Suspension::Join: return "join";
+        case Suspension::Event: return "event";
+        case Suspension::Io: return "io";
+        case Suspension::Finished: return "finished";
+    }
+    return "unknown";
+}
+
+void Profiler::resumed(
+    const char* name,
+    Clock::time_point start,
+    Clock::time_point end,
+    Suspension suspension)
+{
+    auto key = name ? std::string_view{name} : unnamed;
+    auto it = _tasks.find(key);
+    if (it == _tasks.end()) {
+        it = _tasks.emplace(std::string{key}, TaskStats{}).first;
+        it->second.name = key;
+    }
+
+    auto& stats = it->second;
+    stats.resumes++;
+    stats.runTime += end - start;
+    stats.suspensions.at(static_cast<size_t>(suspension))++;
+
+    if (_spans.size() < _spanLimit) {
+        _spans.push_back(Span{
+            .task = &stats,
+            .start = start,
+            .duration = end - start,
+            .suspension = suspension,
+        });
+    }
+}
+
+void Profiler::spanLimit(size_t limit)
+{
+    _spanLimit = limit;
+}
+
+const std::map<std::string, Profiler::TaskStats, std::less<>>&
+Profiler::tasks() const
+{
+    return _tasks;
+}
+
+const std::vector<Profiler::Span>& Profiler::spans() const
+{
+    return _spans;
+}
+
+void Profiler::reset()
+{
+    for (auto& [name, stats] : _tasks) {
+        stats = TaskStats{.name = name};
+    }
+    _spans.clear();
+    _start = Clock::now();
+}
+
+void Profiler::writeChromeTrace(std::ostream& output) const
+{
+    auto trace = tempo::ChromeTraceWriter{output, "as"};
+    for (const auto& span : _spans) {
+        trace.write(tempo::ChromeTraceWriter::Event{
+            .name = span.task->name,
+            .start = span.start - _start,
+            .duration = span.duration,
+            .argumentKey = "suspension",
+            .argumentValue = suspensionName(span.suspension),
+        });
+    }
+}
+
+} // namespace as::coro
@@ -0,0 +1,147 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <as.hpp>
+
+#include <chrono>
+#include <coroutine>
+
+namespace co = as::coro;
+
+using namespace std::chrono_literals;
+
+namespace {
+
+co::Task<> behave(int& resumes)
+{
+    for (;;) {
+        resumes++;
+        co_await std::suspend_always{};
+    }
+}
+
+co::Task<> doze(co::Clock::duration duration)
+{
+    co_await co::sleep(duration);
+}
+
+co::Task<> watch(co::CancellationToken token, int& steps)
+{
+    for (;;) {
+        token.throwIfCancelled();
+        steps++;
+        co_await std::suspend_always{};
+    }
+}
+
+co::Task<> waitForWatchers(
+    co::CancellationToken token, int& steps, bool& cancelled)
+{
+    try {
+        co_await co::whenAll(watch(token, steps), doze(1h));
+    } catch (const co::Cancelled&) {
+        cancelled = true;
+        throw;
+    }
+}
+
+} // namespace
+
+TEST_CASE("Cancelling a group destroys only its chains", "[cancel]")
+{
+    int levelResumes = 0;
+    int otherResumes = 0;
+    auto pool = co::Pool{};
+    auto level = co::Group{};
+
+    for (int i = 0; i < 50'000; i++) {
+        pool.spawn(behave(levelResumes), level);
+    }
+    for (int i = 0; i < 1'000; i++) {
+        pool.spawn(doze(1h), level);
+    }
+    pool << behave(otherResumes);
+    pool.tick();
+    REQUIRE(level.size() == 51'000);
+    REQUIRE(levelResumes == 50'000);
+
+    level.cancel();
+    REQUIRE(level.size() == 0);
+    REQUIRE(level.token().cancelled());
+
+    pool.tick();
+    REQUIRE(levelResumes == 50'000);
+    REQUIRE(otherResumes == 2);
+
+    pool.clear();
+    REQUIRE(pool.empty());
+}
+
+TEST_CASE("Finished chains leave their group", "[cancel]")
+{
+    auto pool = co::Pool{};
+    auto group = co::Group{};
+    pool.spawn(doze(0ms), group);
+    REQUIRE(group.size() == 1);
+
+    pool.tick();
+    REQUIRE(pool.empty());
+    REQUIRE(group.size() == 0);
+}
+
+TEST_CASE("Destroying a group cancels it", "[cancel]")
+{
+    int resumes = 0;
+    auto pool = co::Pool{};
+    {
+        auto group = co::Group{};
+        pool.spawn(behave(resumes), group);
+        pool.tick();
+    }
+    REQUIRE(pool.empty());
+}
+
+TEST_CASE("Cancellation propagates through awaiting chains", "[cancel]")
+{
+    int steps = 0;
+    bool cancelled = false;
+    auto source = co::Group{};
+    auto pool = co::Pool{};
+    pool << waitForWatchers(source.token(), steps, cancelled);
+
+    pool.tick();
+    pool.tick();
+    REQUIRE(steps == 2);
+
+    source.cancel();
+    pool.tick();
+    REQUIRE(cancelled);
+
+    // The sleeping child is stopped, and Cancelled does not leave the pool
+    REQUIRE(pool.empty());
+}
+
+TEST_CASE("A reset group can be used again", "[cancel]")
+{
+    int resumes = 0;
+    int steps = 0;
+    auto pool = co::Pool{};
+    auto group = co::Group{};
+    const auto oldToken = group.token();
+    pool.spawn(behave(resumes), group);
+    pool.tick();
+
+    group.reset();
+    REQUIRE(group.size() == 0);
+    REQUIRE(oldToken.cancelled());
+    REQUIRE(!group.token().cancelled());
+
+    pool.spawn(watch(group.token(), steps), group);
+    pool.tick();
+    pool.tick();
+    REQUIRE(resumes == 1);
+    REQUIRE(steps == 2);
+    REQUIRE(group.size() == 1);
+
+    group.cancel();
+    REQUIRE(pool.empty());
+}
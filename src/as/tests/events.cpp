@@ -0,0 +1,101 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <as.hpp>
+
+#include <evening.hpp>
+
+#include <vector>
+
+namespace co = as::coro;
+
+namespace {
+
+struct Hit {
+    int damage = 0;
+};
+
+struct Death {};
+
+co::Task<> takeHits(evening::Channel& channel, std::vector<int>& damage)
+{
+    for (int i = 0; i < 3; i++) {
+        auto hit = co_await co::next<Hit>(channel);
+        damage.push_back(hit.damage);
+    }
+}
+
+co::Task<> waitForBigHit(evening::Channel& channel, int& damage)
+{
+    auto hit = co_await co::next<Hit>(
+        channel, [] (const Hit& hit) { return hit.damage >= 10; });
+    damage = hit.damage;
+}
+
+co::Task<> waitForDeath(evening::Channel& channel, bool& dead)
+{
+    co_await co::next<Death>(channel);
+    dead = true;
+}
+
+} // namespace
+
+TEST_CASE("Coroutines wait for events", "[events]")
+{
+    auto channel = evening::Channel{};
+    auto damage = std::vector<int>{};
+    auto pool = co::Pool{};
+    pool << takeHits(channel, damage);
+
+    for (int i = 0; i < 10; i++) {
+        pool.tick();
+    }
+    REQUIRE(damage.empty());
+
+    channel.send(Hit{.damage = 3});
+    pool.tick();
+    REQUIRE(damage == std::vector<int>{3});
+
+    // Only the first event is taken by each wait
+    channel.push(Hit{.damage = 5});
+    channel.push(Hit{.damage = 7});
+    channel.deliver();
+    pool.tick();
+    REQUIRE(damage == std::vector<int>{3, 5});
+
+    channel.send(Hit{.damage = 9});
+    pool.tick();
+    REQUIRE(damage == std::vector<int>{3, 5, 9});
+    REQUIRE(pool.empty());
+}
+
+TEST_CASE("Waiting for an event that matches a predicate", "[events]")
+{
+    auto channel = evening::Channel{};
+    int damage = 0;
+    auto pool = co::Pool{};
+    pool << waitForBigHit(channel, damage);
+    pool.tick();
+
+    channel.send(Hit{.damage = 1});
+    pool.tick();
+    REQUIRE(!pool.empty());
+
+    channel.send(Hit{.damage = 12});
+    pool.tick();
+    REQUIRE(damage == 12);
+    REQUIRE(pool.empty());
+}
+
+TEST_CASE("Destroyed waits unsubscribe from the channel", "[events]")
+{
+    auto channel = evening::Channel{};
+    bool dead = false;
+    {
+        auto pool = co::Pool{};
+        pool << waitForDeath(channel, dead);
+        pool.tick();
+    }
+
+    channel.send(Death{});
+    REQUIRE(!dead);
+}
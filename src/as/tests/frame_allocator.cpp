@@ -0,0 +1,75 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <as.hpp>
+
+#include <array>
+#include <coroutine>
+
+namespace co = as::coro;
+
+namespace {
+
+co::Task<> small(int& counter)
+{
+    counter++;
+    co_await std::suspend_always{};
+}
+
+co::Task<> large(int& counter)
+{
+    auto data = std::array<int, 1024>{};
+    data.at(counter % data.size()) = counter;
+    co_await small(counter);
+    counter += data.at(0) == 0 ? 1 : 0;
+}
+
+co::Task<> spawner(co::Pool& pool, int& counter)
+{
+    for (int i = 0; i < 100; i++) {
+        pool << small(counter);
+        co_await small(counter);
+    }
+}
+
+} // namespace
+
+TEST_CASE("Frames are reused in steady state", "[frame-allocator]")
+{
+    int counter = 0;
+    auto pool = co::Pool{};
+
+    pool << spawner(pool, counter);
+    for (int i = 0; i < 10; i++) {
+        pool.tick();
+    }
+
+    auto before = co::frameAllocatorStats();
+    while (!pool.empty()) {
+        pool.tick();
+    }
+    auto after = co::frameAllocatorStats();
+
+    REQUIRE(after.allocations > before.allocations);
+    REQUIRE(after.systemAllocations == before.systemAllocations);
+    REQUIRE(after.deallocations - before.deallocations >=
+        after.allocations - before.allocations);
+    REQUIRE(after.cachedBlocks > 0);
+}
+
+TEST_CASE("Large frames bypass the cache", "[frame-allocator]")
+{
+    int counter = 0;
+    auto pool = co::Pool{};
+    auto before = co::frameAllocatorStats();
+
+    pool << large(counter);
+    while (!pool.empty()) {
+        pool.tick();
+    }
+
+    auto after = co::frameAllocatorStats();
+    REQUIRE(after.systemDeallocations > before.systemDeallocations);
+
+    co::trimFrameCache();
+    REQUIRE(co::frameAllocatorStats().cachedBlocks == 0);
+}
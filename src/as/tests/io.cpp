@@ -0,0 +1,172 @@
+#include "test_data.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <as.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace co = as::coro;
+namespace fs = std::filesystem;
+
+using namespace std::chrono_literals;
+
+namespace {
+
+co::Task<> load(
+    as::io::Service& service,
+    fs::path path,
+    std::vector<std::byte>& data)
+{
+    data = co_await as::io::readFile(service, std::move(path));
+}
+
+co::Task<> loadFailing(as::io::Service& service, fs::path path, bool& failed)
+{
+    try {
+        co_await as::io::readFile(service, std::move(path));
+    } catch (const std::runtime_error&) {
+        failed = true;
+    }
+}
+
+void runUntilEmpty(co::Pool& pool)
+{
+    auto start = co::Clock::now();
+    while (!pool.empty() && co::Clock::now() - start < 10s) {
+        pool.runFor(1ms);
+    }
+}
+
+void testService(as::io::Service& service)
+{
+    const auto directory = fs::temp_directory_path() / "as-io-test";
+    fs::create_directories(directory);
+
+    constexpr size_t fileCount = 300;
+    auto expected = std::vector<std::vector<std::byte>>{};
+    for (size_t i = 0; i < fileCount; i++) {
+        expected.push_back(makeData(i * 97, i));
+        writeBytes(directory / std::to_string(i), expected.back());
+    }
+
+    auto loaded = std::vector<std::vector<std::byte>>(fileCount);
+    bool missingFailed = false;
+    bool directoryFailed = false;
+    auto pool = co::Pool{};
+    for (size_t i = 0; i < fileCount; i++) {
+        pool << load(service, directory / std::to_string(i), loaded[i]);
+    }
+    pool << loadFailing(service, "/nonexistent/as-io-test", missingFailed);
+    pool << loadFailing(service, directory, directoryFailed);
+    runUntilEmpty(pool);
+
+    REQUIRE(pool.empty());
+    REQUIRE(loaded == expected);
+    REQUIRE(missingFailed);
+    REQUIRE(directoryFailed);
+
+    fs::remove_all(directory);
+}
+
+} // namespace
+
+TEST_CASE("Reading files with io_uring", "[io]")
+{
+    auto service = as::io::Service{as::io::Backend::IoUring};
+    testService(service);
+}
+
+TEST_CASE("Reading files with threads", "[io]")
+{
+    auto service = as::io::Service{as::io::Backend::Threads};
+    REQUIRE(service.backend() == as::io::Backend::Threads);
+    testService(service);
+}
+
+TEST_CASE("Destroyed reads do not wake their pool", "[io]")
+{
+    auto service = as::io::Service{};
+    auto data = std::vector<std::byte>{};
+    {
+        auto pool = co::Pool{};
+        pool << load(service, "/proc/self/status", data);
+        pool.tick();
+    }
+    REQUIRE(data.empty());
+}
+
+#ifdef __linux__
+
+namespace {
+
+// Let a read blocked on the FIFO finish, by opening it for writing once the
+// engine has opened it for reading. io_uring does not wait for a writer, so
+// by then there may be no reader left, and nothing to unblock.
+void unblock(const fs::path& fifo)
+{
+    const auto start = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() - start < 500ms) {
+        int fd = open( // NOLINT
+            fifo.c_str(), O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+        if (fd >= 0) {
+            close(fd);
+            return;
+        }
+        std::this_thread::sleep_for(1ms);
+    }
+}
+
+void testStoppedRead(as::io::Backend backend, bool clear)
+{
+    const auto fifo = fs::temp_directory_path() / "as-io-test-fifo";
+    fs::remove(fifo);
+    REQUIRE(mkfifo(fifo.c_str(), 0600) == 0);
+
+    auto data = std::vector<std::byte>{};
+    auto pool = co::Pool{};
+    auto group = co::Group{};
+    {
+        auto service = as::io::Service{backend};
+        pool.spawn(load(service, fifo, data), group);
+        pool.tick();
+
+        if (clear) {
+            pool.clear();
+        } else {
+            group.cancel();
+        }
+        unblock(fifo);
+
+        // Destroying the service waits for the read to complete
+    }
+
+    pool.tick();
+    REQUIRE(pool.empty());
+    REQUIRE(data.empty());
+    fs::remove(fifo);
+}
+
+} // namespace
+
+TEST_CASE("Reads in flight do not wake cancelled chains", "[io]")
+{
+    for (auto backend : {as::io::Backend::IoUring, as::io::Backend::Threads}) {
+        testStoppedRead(backend, false);
+        testStoppedRead(backend, true);
+    }
+}
+
+#endif
@@ -0,0 +1,254 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <as.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <coroutine>
+#include <stdexcept>
+#include <vector>
+
+namespace co = as::coro;
+
+using namespace std::chrono_literals;
+
+namespace {
+
+co::Task<> count(int& counter, int steps)
+{
+    for (int i = 0; i < steps; i++) {
+        counter++;
+        co_await std::suspend_always{};
+    }
+}
+
+co::Task<> sleepy(int& resumes, std::vector<int>& order, int id,
+    co::Clock::duration duration)
+{
+    resumes++;
+    co_await co::sleep(duration);
+    resumes++;
+    order.push_back(id);
+}
+
+co::Task<> nestedSleep(int& resumes)
+{
+    co_await co::sleep(10ms);
+    resumes++;
+}
+
+co::Task<> sleepInSubtask(int& resumes)
+{
+    co_await nestedSleep(resumes);
+    resumes++;
+}
+
+co::Task<> fail()
+{
+    co_await std::suspend_always{};
+    throw std::runtime_error{"failure"};
+}
+
+co::Task<> failInSubtask()
+{
+    co_await fail();
+}
+
+co::Task<int> twice(int value)
+{
+    co_await std::suspend_always{};
+    co_return 2 * value;
+}
+
+co::Task<> sum(int& result)
+{
+    result = co_await twice(1) + co_await twice(20);
+}
+
+co::Task<> busy(int& resumes, co::Clock::duration work)
+{
+    for (;;) {
+        resumes++;
+        auto end = co::Clock::now() + work;
+        while (co::Clock::now() < end) {
+        }
+        co_await std::suspend_always{};
+    }
+}
+
+co::Task<> catchFailure(bool& caught)
+{
+    try {
+        co_await fail();
+    } catch (const std::runtime_error&) {
+        caught = true;
+    }
+}
+
+} // namespace
+
+TEST_CASE("Pool resumes chains and subtasks", "[pool]")
+{
+    int counter = 0;
+    auto pool = co::Pool{};
+    pool << count(counter, 2) << count(counter, 3);
+
+    pool.tick();
+    REQUIRE(counter == 2);
+    pool.tick();
+    REQUIRE(counter == 4);
+    pool.tick();
+    REQUIRE(counter == 5);
+    pool.tick();
+    REQUIRE(pool.empty());
+}
+
+TEST_CASE("Sleeping coroutines are not resumed before they are due", "[pool]")
+{
+    int resumes = 0;
+    auto order = std::vector<int>{};
+    auto pool = co::Pool{};
+    pool << sleepy(resumes, order, 1, 30ms) << sleepy(resumes, order, 2, 10ms);
+
+    pool.tick();
+    REQUIRE(resumes == 2);
+    REQUIRE(!pool.empty());
+
+    for (int i = 0; i < 100; i++) {
+        pool.tick();
+    }
+    REQUIRE(resumes == 2);
+
+    pool.runFor(100ms);
+    REQUIRE(resumes == 4);
+    REQUIRE(order == std::vector<int>{2, 1});
+    REQUIRE(pool.empty());
+}
+
+TEST_CASE("Sleep in subtask", "[pool]")
+{
+    int resumes = 0;
+    auto pool = co::Pool{};
+    pool << sleepInSubtask(resumes);
+
+    auto start = co::Clock::now();
+    while (!pool.empty()) {
+        pool.runFor(1ms);
+    }
+    REQUIRE(co::Clock::now() - start >= 10ms);
+    REQUIRE(resumes == 2);
+}
+
+TEST_CASE("Run until a deadline of another clock", "[pool]")
+{
+    int resumes = 0;
+    auto order = std::vector<int>{};
+    auto pool = co::Pool{};
+    pool << sleepy(resumes, order, 1, 10ms);
+
+    const auto start = std::chrono::steady_clock::now();
+    pool.runUntil(start + 30ms);
+    REQUIRE(std::chrono::steady_clock::now() - start >= 30ms);
+    REQUIRE(resumes == 2);
+    REQUIRE(pool.empty());
+
+    pool.runUntil(std::chrono::high_resolution_clock::now() + 1ms);
+}
+
+TEST_CASE("Clear destroys sleeping chains", "[pool]")
+{
+    int resumes = 0;
+    auto order = std::vector<int>{};
+    auto pool = co::Pool{};
+    pool << sleepy(resumes, order, 1, 1h);
+    pool.tick();
+    REQUIRE(!pool.empty());
+
+    pool.clear();
+    REQUIRE(pool.empty());
+}
+
+TEST_CASE("Failed chains are removed from the pool", "[pool]")
+{
+    int counter = 0;
+    auto pool = co::Pool{};
+    pool << failInSubtask() << count(counter, 3);
+
+    pool.tick();
+    pool.tick();
+    REQUIRE_THROWS_AS(pool.tick(), std::runtime_error);
+
+    while (!pool.empty()) {
+        pool.tick();
+    }
+    REQUIRE(counter == 3);
+}
+
+TEST_CASE("Awaiting a task yields its result", "[pool]")
+{
+    int result = 0;
+    auto pool = co::Pool{};
+    pool << sum(result);
+    while (!pool.empty()) {
+        pool.tick();
+    }
+    REQUIRE(result == 42);
+}
+
+TEST_CASE("Subtask exceptions reach the awaiting coroutine", "[pool]")
+{
+    bool caught = false;
+    auto pool = co::Pool{};
+    pool << catchFailure(caught);
+    while (!pool.empty()) {
+        pool.tick();
+    }
+    REQUIRE(caught);
+}
+
+TEST_CASE("Budgeted ticks resume chains in turn", "[pool]")
+{
+    auto resumes = std::vector<int>(10);
+    auto pool = co::Pool{};
+    for (auto& count : resumes) {
+        pool << busy(count, 1ms);
+    }
+
+    // Every tick resumes at least one chain, and later ticks continue with
+    // the chains that were left out
+    for (int i = 0; i < 20; i++) {
+        pool.tick(co::Clock::duration{0});
+    }
+    REQUIRE(std::ranges::all_of(resumes, [] (int n) { return n == 2; }));
+
+    pool.tick(3500us);
+    auto total = 0;
+    for (int n : resumes) {
+        total += n;
+    }
+    REQUIRE(total > 20);
+    REQUIRE(total <= 24);
+}
+
+TEST_CASE("Higher priority chains are resumed first", "[pool]")
+{
+    int low = 0;
+    int normal = 0;
+    int high = 0;
+    auto pool = co::Pool{};
+    pool.spawn(busy(low, 0ms), co::Priority::Low);
+    pool << busy(normal, 0ms);
+    pool.spawn(busy(high, 0ms), co::Priority::High);
+
+    for (int i = 0; i < 3; i++) {
+        pool.tick(co::Clock::duration{0});
+    }
+    REQUIRE(high == 3);
+    REQUIRE(normal == 0);
+    REQUIRE(low == 0);
+
+    pool.tick();
+    REQUIRE(high == 4);
+    REQUIRE(normal == 1);
+    REQUIRE(low == 1);
+}
@@ -0,0 +1,73 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <as.hpp>
+
+#include <chrono>
+#include <coroutine>
+#include <sstream>
+#include <string>
+
+namespace co = as::coro;
+
+using namespace std::chrono_literals;
+
+namespace {
+
+co::Task<> step()
+{
+    co_await std::suspend_always{};
+}
+
+co::Task<> walk()
+{
+    co_await step();
+    co_await step();
+    co_await co::sleep(0ms);
+}
+
+co::Task<> nap()
+{
+    co_await co::sleep(1h);
+}
+
+} // namespace
+
+TEST_CASE("Profiler collects statistics per task name", "[profiler]")
+{
+    auto profiler = co::Profiler{};
+    auto pool = co::Pool{};
+    pool.profiler(&profiler);
+    pool << walk().named("walk") << nap().named("nap") << step();
+
+    for (int i = 0; i < 5; i++) {
+        pool.tick();
+    }
+
+    const auto& tasks = profiler.tasks();
+    REQUIRE(tasks.size() == 3);
+
+    const auto& walkStats = tasks.at("walk");
+    REQUIRE(walkStats.resumes == 5);
+    REQUIRE(walkStats.suspensions.at(
+        static_cast<size_t>(co::Suspension::Yield)) == 4);
+    REQUIRE(walkStats.suspensions.at(
+        static_cast<size_t>(co::Suspension::Finished)) == 1);
+
+    const auto& napStats = tasks.at("nap");
+    REQUIRE(napStats.resumes == 1);
+    REQUIRE(napStats.suspensions.at(
+        static_cast<size_t>(co::Suspension::Sleep)) == 1);
+
+    REQUIRE(tasks.at("<unnamed>").resumes == 2);
+
+    auto trace = std::ostringstream{};
+    profiler.writeChromeTrace(trace);
+    REQUIRE(trace.str().find("\"name\":\"walk\"") != std::string::npos);
+    REQUIRE(trace.str().find("\"suspension\":\"sleep\"") != std::string::npos);
+
+    pool.profiler(nullptr);
+    profiler.reset();
+    pool.tick();
+    REQUIRE(profiler.spans().empty());
+    REQUIRE(tasks.at("walk").resumes == 0);
+}
@@ -0,0 +1,165 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <as.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <stdexcept>
+
+namespace co = as::coro;
+
+using namespace std::chrono_literals;
+
+namespace {
+
+co::Task<> count(std::atomic<int>& counter, int steps)
+{
+    for (int i = 0; i < steps; i++) {
+        counter++;
+        co_await std::suspend_always{};
+    }
+}
+
+co::Task<> nested(std::atomic<int>& counter, int depth)
+{
+    if (depth > 0) {
+        co_await nested(counter, depth - 1);
+    }
+    co_await count(counter, 2);
+}
+
+co::Task<> countAfter(std::atomic<int>& counter, co::Clock::duration delay)
+{
+    co_await co::sleep(delay);
+    counter++;
+}
+
+co::Task<> cancel()
+{
+    co_await std::suspend_always{};
+    throw co::Cancelled{};
+}
+
+co::Task<> fail()
+{
+    co_await std::suspend_always{};
+    throw std::runtime_error{"failure"};
+}
+
+} // namespace
+
+TEST_CASE("Threaded pool runs every chain once per tick", "[threaded-pool]")
+{
+    auto counter = std::atomic<int>{0};
+    auto pool = co::ThreadedPool{4};
+    REQUIRE(pool.threadCount() == 4);
+
+    for (int i = 0; i < 1000; i++) {
+        pool << count(counter, 3);
+    }
+
+    pool.tick();
+    REQUIRE(counter == 1000);
+    pool.tick();
+    REQUIRE(counter == 2000);
+    pool.tick();
+    REQUIRE(counter == 3000);
+    REQUIRE(!pool.empty());
+
+    pool.tick();
+    REQUIRE(counter == 3000);
+    REQUIRE(pool.empty());
+}
+
+TEST_CASE("Threaded pool follows subtasks", "[threaded-pool]")
+{
+    auto counter = std::atomic<int>{0};
+    auto pool = co::ThreadedPool{3};
+
+    for (int i = 0; i < 100; i++) {
+        pool << nested(counter, 5);
+    }
+    while (!pool.empty()) {
+        pool.tick();
+    }
+    REQUIRE(counter == 100 * 6 * 2);
+}
+
+TEST_CASE("Threaded pool rethrows exceptions after the tick", "[threaded-pool]")
+{
+    auto counter = std::atomic<int>{0};
+    auto pool = co::ThreadedPool{2};
+
+    pool << fail();
+    for (int i = 0; i < 10; i++) {
+        pool << count(counter, 2);
+    }
+
+    pool.tick();
+    REQUIRE_THROWS_AS(pool.tick(), std::runtime_error);
+    REQUIRE(counter == 20);
+
+    pool.tick();
+    REQUIRE(pool.empty());
+}
+
+TEST_CASE("Threaded pool finishes cancelled chains quietly", "[threaded-pool]")
+{
+    auto counter = std::atomic<int>{0};
+    auto pool = co::ThreadedPool{2};
+
+    pool << cancel();
+    pool << count(counter, 2);
+    pool.tick();
+    REQUIRE_NOTHROW(pool.tick());
+    pool.tick();
+    REQUIRE(counter == 2);
+    REQUIRE(pool.empty());
+}
+
+TEST_CASE("Threaded pool resumes sleeping chains when they are due",
+    "[threaded-pool]")
+{
+    auto counter = std::atomic<int>{0};
+    auto pool = co::ThreadedPool{2};
+    pool << countAfter(counter, 1h);
+    pool << countAfter(counter, 20ms);
+
+    pool.tick();
+    pool.tick();
+    REQUIRE(counter == 0);
+    REQUIRE(!pool.empty());
+
+    pool.runFor(100ms);
+    REQUIRE(counter == 1);
+    REQUIRE(!pool.empty());
+
+    pool.clear();
+    REQUIRE(pool.empty());
+}
+
+TEST_CASE("Threaded pool runs until a steady clock deadline",
+    "[threaded-pool]")
+{
+    auto counter = std::atomic<int>{0};
+    auto pool = co::ThreadedPool{2};
+    pool << count(counter, 3);
+
+    const auto start = std::chrono::steady_clock::now();
+    pool.runUntil(start + 10ms);
+    REQUIRE(std::chrono::steady_clock::now() - start >= 10ms);
+    REQUIRE(counter == 3);
+    REQUIRE(pool.empty());
+}
+
+TEST_CASE("Threaded pool clears unfinished chains", "[threaded-pool]")
+{
+    auto counter = std::atomic<int>{0};
+    auto pool = co::ThreadedPool{2};
+    pool << nested(counter, 3);
+    pool.tick();
+    pool.tick();
+    pool.clear();
+    REQUIRE(pool.empty());
+}
@@ -0,0 +1,186 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <as.hpp>
+
+#include <chrono>
+#include <coroutine>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace co = as::coro;
+
+using namespace std::chrono_literals;
+
+namespace {
+
+co::Task<int> countTo(int& counter, int steps)
+{
+    for (int i = 0; i < steps; i++) {
+        counter++;
+        co_await std::suspend_always{};
+    }
+    co_return steps;
+}
+
+co::Task<std::string> name()
+{
+    co_await std::suspend_always{};
+    co_return "eater";
+}
+
+co::Task<> nothing()
+{
+    co_return;
+}
+
+co::Task<> sleepFor(co::Clock::duration duration)
+{
+    co_await co::sleep(duration);
+}
+
+co::Task<int> fail()
+{
+    co_await std::suspend_always{};
+    throw std::runtime_error{"failure"};
+}
+
+co::Task<> runAll(int& counter, int& ticks, int& total, std::string& text)
+{
+    auto [a, b, c, d] = co_await co::whenAll(
+        countTo(counter, 3), countTo(counter, 5), name(), nothing());
+    total = a + b;
+    text = c;
+    ticks = counter;
+}
+
+co::Task<> runAllVector(std::vector<int>& results)
+{
+    auto counter = 0;
+    auto tasks = std::vector<co::Task<int>>{};
+    for (int steps = 1; steps <= 4; steps++) {
+        tasks.push_back(countTo(counter, steps));
+    }
+    results = co_await co::whenAll(std::move(tasks));
+}
+
+co::Task<> runAny(int& counter, size_t& index, int& value)
+{
+    auto result = co_await co::whenAny(
+        countTo(counter, 10), countTo(counter, 2), countTo(counter, 5));
+    index = result.index;
+    value = result.value;
+}
+
+co::Task<> raceSleeps(size_t& index)
+{
+    index = co_await co::whenAny(sleepFor(1h), sleepFor(1ms));
+}
+
+co::Task<> failAll(int& counter, bool& caught)
+{
+    try {
+        co_await co::whenAll(countTo(counter, 100), fail());
+    } catch (const std::runtime_error&) {
+        caught = true;
+    }
+}
+
+void runToCompletion(co::Pool& pool, int& ticks)
+{
+    while (!pool.empty()) {
+        pool.tick();
+        ticks++;
+    }
+}
+
+} // namespace
+
+TEST_CASE("whenAll runs children in the same ticks", "[when]")
+{
+    int counter = 0;
+    int ticksAtResume = 0;
+    int total = 0;
+    auto text = std::string{};
+    auto pool = co::Pool{};
+    pool << runAll(counter, ticksAtResume, total, text);
+
+    int ticks = 0;
+    runToCompletion(pool, ticks);
+    REQUIRE(total == 8);
+    REQUIRE(text == "eater");
+    REQUIRE(ticksAtResume == 8);
+
+    // Latency is that of the longest child, not the sum of all of them
+    REQUIRE(ticks <= 7);
+}
+
+TEST_CASE("whenAll over a vector of tasks", "[when]")
+{
+    auto results = std::vector<int>{};
+    auto pool = co::Pool{};
+    pool << runAllVector(results);
+
+    int ticks = 0;
+    runToCompletion(pool, ticks);
+    REQUIRE(results == std::vector<int>{1, 2, 3, 4});
+}
+
+TEST_CASE("whenAny resumes with the first finished task", "[when]")
+{
+    int counter = 0;
+    size_t index = 99;
+    int value = 0;
+    auto pool = co::Pool{};
+    pool << runAny(counter, index, value);
+
+    int ticks = 0;
+    runToCompletion(pool, ticks);
+    REQUIRE(index == 1);
+    REQUIRE(value == 2);
+
+    // The others are stopped after the winner finishes
+    REQUIRE(counter < 10);
+}
+
+TEST_CASE("whenAny stops sleeping losers", "[when]")
+{
+    size_t index = 99;
+    auto pool = co::Pool{};
+    pool << raceSleeps(index);
+
+    auto start = co::Clock::now();
+    while (!pool.empty() && co::Clock::now() - start < 1s) {
+        pool.runFor(1ms);
+    }
+    REQUIRE(pool.empty());
+    REQUIRE(index == 1);
+}
+
+TEST_CASE("whenAll rethrows the exception of a failed child", "[when]")
+{
+    int counter = 0;
+    bool caught = false;
+    auto pool = co::Pool{};
+    pool << failAll(counter, caught);
+
+    int ticks = 0;
+    runToCompletion(pool, ticks);
+    REQUIRE(caught);
+    REQUIRE(counter < 100);
+}
+
+TEST_CASE("Clear destroys waiting chains and their children", "[when]")
+{
+    int counter = 0;
+    bool caught = false;
+    size_t index = 99;
+    auto pool = co::Pool{};
+    pool << failAll(counter, caught) << raceSleeps(index);
+    pool.tick();
+    REQUIRE(!pool.empty());
+
+    pool.clear();
+    REQUIRE(pool.empty());
+}
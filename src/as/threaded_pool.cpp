@@ -0,0 +1,271 @@
+#include <as/threaded_pool.hpp>
+
+#include <as/cancel.hpp>
+
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <utility>
+
+namespace as::coro {
+
+namespace {
+
+bool cancelled(const std::exception_ptr& exception)
+{
+    try {
+        std::rethrow_exception(exception);
+    } catch (const Cancelled&) {
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+// Orders the sleeper heap so that the earliest wake time is on top
+bool wakesLater(const PromiseBase* a, const PromiseBase* b)
+{
+    return a->leaf->wakeTime > b->leaf->wakeTime;
+}
+
+} // namespace
+
+ThreadedPool::ThreadedPool(size_t threadCount)
+{
+    threadCount = std::max<size_t>(threadCount, 1);
+    for (size_t i = 0; i < threadCount; i++) {
+        _workers.push_back(std::make_unique<Worker>());
+    }
+
+    // Worker 0 is the thread calling tick()
+    for (size_t i = 1; i < threadCount; i++) {
+        _workers.at(i)->thread = std::thread{&ThreadedPool::work, this, i};
+    }
+}
+
+ThreadedPool::~ThreadedPool()
+{
+    {
+        auto lock = std::scoped_lock{_mutex};
+        _stop = true;
+    }
+    _tickStarted.notify_all();
+    for (auto& worker : _workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+
+    clear();
+}
+
+bool ThreadedPool::empty() const
+{
+    return _chains.empty() && _sleepers.empty();
+}
+
+size_t ThreadedPool::threadCount() const
+{
+    return _workers.size();
+}
+
+void ThreadedPool::spawn(PromiseBase& root)
+{
+    root.root = &root;
+    root.leaf = &root;
+    _chains.push_back(&root);
+}
+
+void ThreadedPool::tick()
+{
+    wakeSleepers(Clock::now());
+    if (_chains.empty()) {
+        return;
+    }
+
+    // Hand out contiguous ranges of chains, so that workers rarely have to
+    // steal when coroutines take similar time
+    const auto workerCount = _workers.size();
+    for (size_t w = 0; w < workerCount; w++) {
+        auto& worker = *_workers.at(w);
+        auto lock = std::scoped_lock{worker.mutex};
+        for (size_t i = w * _chains.size() / workerCount;
+                i < (w + 1) * _chains.size() / workerCount; i++) {
+            worker.chains.push_back(i);
+        }
+    }
+
+    {
+        auto lock = std::scoped_lock{_mutex};
+        _busyWorkers = workerCount - 1;
+        _tickNumber++;
+    }
+    _tickStarted.notify_all();
+
+    drain(0);
+
+    {
+        auto lock = std::unique_lock{_mutex};
+        _tickFinished.wait(lock, [this] { return _busyWorkers == 0; });
+    }
+
+    retire();
+}
+
+void ThreadedPool::clear()
+{
+    for (auto* root : _chains) {
+        internals::destroyChain(root);
+    }
+    _chains.clear();
+    for (auto* root : _sleepers) {
+        internals::destroyChain(root);
+    }
+    _sleepers.clear();
+}
+
+void ThreadedPool::work(size_t workerIndex)
+{
+    uint64_t lastTick = 0;
+    for (;;) {
+        {
+            auto lock = std::unique_lock{_mutex};
+            _tickStarted.wait(lock, [this, lastTick] {
+                return _stop || _tickNumber != lastTick;
+            });
+            if (_stop) {
+                return;
+            }
+            lastTick = _tickNumber;
+        }
+
+        drain(workerIndex);
+
+        {
+            auto lock = std::scoped_lock{_mutex};
+            if (--_busyWorkers == 0) {
+                _tickFinished.notify_one();
+            }
+        }
+    }
+}
+
+void ThreadedPool::drain(size_t workerIndex)
+{
+    auto& worker = *_workers.at(workerIndex);
+    for (size_t chainIndex = 0;
+            pop(workerIndex, chainIndex) || steal(workerIndex, chainIndex); ) {
+        switch (step(chainIndex)) {
+            case StepResult::Yielded:
+                break;
+            case StepResult::Slept:
+                worker.slept.push_back(chainIndex);
+                break;
+            case StepResult::Finished:
+                worker.finished.push_back(chainIndex);
+                break;
+        }
+    }
+}
+
+bool ThreadedPool::pop(size_t workerIndex, size_t& chainIndex)
+{
+    auto& worker = *_workers.at(workerIndex);
+    auto lock = std::scoped_lock{worker.mutex};
+    if (worker.chains.empty()) {
+        return false;
+    }
+    chainIndex = worker.chains.back();
+    worker.chains.pop_back();
+    return true;
+}
+
+bool ThreadedPool::steal(size_t workerIndex, size_t& chainIndex)
+{
+    const auto workerCount = _workers.size();
+    for (size_t offset = 1; offset < workerCount; offset++) {
+        auto& victim = *_workers.at((workerIndex + offset) % workerCount);
+        auto lock = std::scoped_lock{victim.mutex};
+        if (!victim.chains.empty()) {
+            chainIndex = victim.chains.front();
+            victim.chains.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+ThreadedPool::StepResult ThreadedPool::step(size_t chainIndex)
+{
+    auto* root = _chains.at(chainIndex);
+    if (internals::resumeChain(root)) {
+        return StepResult::Finished;
+    }
+    return root->leaf->wakeTime != Clock::time_point{} ?
+        StepResult::Slept : StepResult::Yielded;
+}
+
+void ThreadedPool::retire()
+{
+    // Chains are taken out from the highest index down, so that the last
+    // chain swapped into a freed slot is never one still to be taken out
+    auto indices = std::vector<size_t>{};
+    for (auto& worker : _workers) {
+        for (auto i : worker->finished) {
+            _finished.push_back(_chains.at(i));
+            indices.push_back(i);
+        }
+        for (auto i : worker->slept) {
+            _sleepers.push_back(_chains.at(i));
+            std::ranges::push_heap(_sleepers, wakesLater);
+            indices.push_back(i);
+        }
+        worker->finished.clear();
+        worker->slept.clear();
+    }
+    std::ranges::sort(indices, std::greater<>{});
+    for (auto i : indices) {
+        std::swap(_chains.at(i), _chains.back());
+        _chains.pop_back();
+    }
+
+    // As in Pool, chains that were cancelled finish quietly
+    auto exception = std::exception_ptr{};
+    for (auto* root : _finished) {
+        if (root->exception && !exception && !cancelled(root->exception)) {
+            exception = root->exception;
+        }
+        internals::destroyChain(root);
+    }
+    _finished.clear();
+
+    if (exception) {
+        std::rethrow_exception(exception);
+    }
+}
+
+Clock::time_point ThreadedPool::nextWakeTime() const
+{
+    return _sleepers.empty() ? Clock::time_point::max() :
+        _sleepers.front()->leaf->wakeTime;
+}
+
+void ThreadedPool::wakeSleepers(Clock::time_point now)
+{
+    while (!_sleepers.empty() && _sleepers.front()->leaf->wakeTime <= now) {
+        std::ranges::pop_heap(_sleepers, wakesLater);
+        auto* root = _sleepers.back();
+        _sleepers.pop_back();
+        root->leaf->wakeTime = {};
+        _chains.push_back(root);
+    }
+}
+
+// Nothing but the calling thread adds chains, so there is nothing to wake
+// up for before the time
+void ThreadedPool::waitForWork(Clock::time_point until)
+{
+    std::this_thread::sleep_for(until - Clock::now());
+}
+
+} // namespace as::coro
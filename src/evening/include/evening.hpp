@@ -27,14 +27,73 @@ SOFTWARE.
 #pragma once
 
 #include <any>
+#include <cstdint>
+#include <deque>
 #include <functional>
+#include <limits>
 #include <map>
 #include <memory>
+#include <span>
+#include <type_traits>
 #include <typeindex>
+#include <utility>
 #include <vector>
 
+#ifdef EVENING_TRACE
+#include <evening/trace.hpp>
+#endif
+
 namespace evening {
 
+/**
+ * Identifies a single subscription within a channel. Tokens stay cheap to
+ * copy and become stale once the subscription they refer to is removed.
+ */
+class Token {
+public:
+    Token() = default;
+
+    [[nodiscard]] bool valid() const
+    {
+        return _list != invalid;
+    }
+
+private:
+    static constexpr uint32_t invalid = std::numeric_limits<uint32_t>::max();
+
+    Token(uint32_t list, uint32_t slot, uint32_t generation)
+        : _list(list)
+        , _slot(slot)
+        , _generation(generation)
+    { }
+
+    uint32_t _list = invalid;
+    uint32_t _slot = 0;
+    uint32_t _generation = 0;
+
+    friend class Channel;
+};
+
+/**
+ * Receives raw copies of trivially copyable events passing through a channel,
+ * along with delivery points, e.g. to log the event stream for replay.
+ */
+class Recorder {
+public:
+    enum class Kind : uint8_t {
+        Send,
+        Push,
+        Deliver,
+    };
+
+    virtual ~Recorder() = default;
+
+    virtual void record(
+        Kind kind,
+        std::type_index type,
+        std::span<const std::byte> payload) = 0;
+};
+
 class Channel final {
 public:
     Channel() = default;
@@ -48,27 +107,25 @@ public:
      * Subscribe to channel, providing a tracker.
      */
     template <class Event, class Tracker>
-    void subscribe(
+    Token subscribe(
         std::weak_ptr<Tracker> tracker,
         std::function<void(const Event&)> handler)
     {
-        _handlers[std::type_index(typeid(Event))].push_back(
-            [tracker, handler] (const std::any& event) -> bool {
-                if (tracker.expired()) {
-                    return false;
-                }
-
-                handler(std::any_cast<Event>(event));
-                return true;
+        return addHandler(
+            listIndex(std::type_index(typeid(Event))),
+            std::weak_ptr<const void>(std::move(tracker)),
+            true,
+            [handler = std::move(handler)] (const std::any& event) {
+                handler(std::any_cast<const Event&>(event));
             });
     }
 
     template <class Event, class Tracker>
-    void subscribe(
+    Token subscribe(
         const std::shared_ptr<Tracker>& tracker,
         std::function<void(const Event&)> handler)
     {
-        subscribe(std::weak_ptr<Tracker>(tracker), handler);
+        return subscribe(std::weak_ptr<Tracker>(tracker), std::move(handler));
     }
 
     /**
@@ -78,41 +135,100 @@ public:
     std::shared_ptr<char> subscribe(std::function<void(const Event&)> handler)
     {
         auto life = std::make_shared<char>();
-        std::weak_ptr<char> tracker = life;
-        _handlers[std::type_index(typeid(Event))].push_back(
-            [tracker, handler] (const std::any& event) -> bool {
-                if (tracker.expired()) {
-                    return false;
-                }
+        subscribe(std::weak_ptr<char>(life), std::move(handler));
+        return life;
+    }
 
-                handler(std::any_cast<Event>(event));
-                return true;
+    /**
+     * Subscribe to channel until explicitly unsubscribed with the returned
+     * token.
+     */
+    template <class Event>
+    Token listen(std::function<void(const Event&)> handler)
+    {
+        return addHandler(
+            listIndex(std::type_index(typeid(Event))),
+            {},
+            false,
+            [handler = std::move(handler)] (const std::any& event) {
+                handler(std::any_cast<const Event&>(event));
             });
+    }
 
-        return life;
+    /**
+     * Remove a subscription in constant time. Returns false if the token is
+     * stale, i.e. the subscription has already been removed.
+     */
+    bool unsubscribe(const Token& token)
+    {
+        if (!token.valid() || token._list >= _lists.size()) {
+            return false;
+        }
+
+        auto& list = _lists[token._list];
+        if (token._slot >= list.slots.size() ||
+                list.slots[token._slot].generation != token._generation) {
+            return false;
+        }
+
+        kill(list, list.slots[token._slot].entry);
+        if (list.dispatchDepth == 0 &&
+                list.deadCount * 2 > list.entries.size()) {
+            compact(list);
+        }
+        return true;
+    }
+
+    /**
+     * Drop handlers that were unsubscribed or whose trackers have expired,
+     * and release unused memory.
+     */
+    void compact()
+    {
+        for (auto& list : _lists) {
+            if (list.dispatchDepth == 0) {
+                compact(list);
+                list.entries.shrink_to_fit();
+            }
+        }
     }
 
     template <class Event>
     void push(const Event& event)
     {
-        _events[std::type_index(typeid(Event))].push_back(event);
+        auto& queue = _events[std::type_index(typeid(Event))];
+        queue.push_back(event);
+        record(Recorder::Kind::Push, event);
+#ifdef EVENING_TRACE
+        _trace.pushed(_trace.type(typeid(Event)), queue.size());
+#endif
     }
 
     template <class Event, class... Args>
     void makePush(Args&&... args)
     {
-        _events[std::type_index(typeid(Event))].emplace_back(Event(std::forward<Args>(args)...));
+        auto& queue = _events[std::type_index(typeid(Event))];
+        queue.emplace_back(Event(std::forward<Args>(args)...));
+        record(Recorder::Kind::Push, std::any_cast<const Event&>(queue.back()));
+#ifdef EVENING_TRACE
+        _trace.pushed(_trace.type(typeid(Event)), queue.size());
+#endif
     }
 
     template <class Event>
     void send(const Event& event)
     {
-        auto handlersPairIt = _handlers.find(std::type_index(typeid(Event)));
-        if (handlersPairIt == _handlers.end()) {
+#ifdef EVENING_TRACE
+        _trace.type(typeid(Event)).sent++;
+#endif
+        record(Recorder::Kind::Send, event);
+
+        auto listIt = _listIndices.find(std::type_index(typeid(Event)));
+        if (listIt == _listIndices.end()) {
             return;
         }
 
-        sendEvent(event, handlersPairIt);
+        sendEvent(event, _lists[listIt->second]);
     }
 
     template <class Event, class... Args>
@@ -123,46 +239,296 @@ public:
 
     void deliver()
     {
+        if (recording()) {
+            _recorder->record(Recorder::Kind::Deliver, typeid(void), {});
+        }
+
         for (auto eventsPairIt = _events.begin();
                 eventsPairIt != _events.end();) {
             const auto& eventTypeIndex = eventsPairIt->first;
             const auto& eventVector = eventsPairIt->second;
 
-            auto handlersPairIt = _handlers.find(eventTypeIndex);
-            if (handlersPairIt != _handlers.end()) {
+#ifdef EVENING_TRACE
+            _trace.type(eventTypeIndex).delivered += eventVector.size();
+#endif
+            auto listIt = _listIndices.find(eventTypeIndex);
+            if (listIt != _listIndices.end()) {
                 for (const auto& event : eventVector) {
-                    sendEvent(event, handlersPairIt);
+                    sendEvent(event, _lists[listIt->second]);
                 }
             }
             eventsPairIt = _events.erase(eventsPairIt);
         }
     }
 
+    /**
+     * Start passing events to the recorder, or stop recording if it is null.
+     * Events that are not trivially copyable are not recorded, and neither
+     * are events that handlers push or send during dispatch, since replaying
+     * the events that caused them produces them again.
+     */
+    void recorder(Recorder* recorder)
+    {
+        _recorder = recorder;
+    }
+
+#ifdef EVENING_TRACE
+    [[nodiscard]] const Trace& trace() const
+    {
+        return _trace;
+    }
+
+    Trace& trace()
+    {
+        return _trace;
+    }
+#endif
+
 private:
-    using Handler = std::function<bool(const std::any&)>;
-    using HandlerMap = std::map<std::type_index, std::vector<Handler>>;
+    using Handler = std::function<void(const std::any&)>;
+
+    // A subscribed handler. Unsubscribed handlers stay in place until the list
+    // is compacted, so that dispatch never has to shift the vector it is
+    // iterating over.
+    struct Entry {
+        Handler handler;
+        std::weak_ptr<const void> tracker;
+        uint32_t slot = 0;
+        bool tracked = false;
+        bool alive = true;
+    };
+
+    // Stable indirection from tokens to entries, which move on compaction.
+    struct Slot {
+        uint32_t generation = 0;
+        uint32_t entry = 0;
+    };
+
+    struct HandlerList {
+        std::vector<Entry> entries;
+        std::vector<Entry> pending;
+        std::vector<Slot> slots;
+        std::vector<uint32_t> freeSlots;
+        std::vector<uint32_t> killedDuringDispatch;
+        size_t deadCount = 0;
+        int dispatchDepth = 0;
+#ifdef EVENING_TRACE
+        Trace::TypeStats* stats = nullptr;
+#endif
+    };
+
+    [[nodiscard]] bool recording() const
+    {
+        return _recorder && _dispatchDepth == 0;
+    }
+
+    template <class Event>
+    void record(Recorder::Kind kind, const Event& event)
+    {
+        if constexpr (std::is_trivially_copyable_v<Event>) {
+            if (recording()) {
+                _recorder->record(
+                    kind,
+                    typeid(Event),
+                    std::as_bytes(std::span<const Event, 1>{&event, 1}));
+            }
+        }
+    }
 
-    void sendEvent(
-        const std::any& event,
-        HandlerMap::iterator handlersIter)
+    uint32_t listIndex(std::type_index type)
     {
-        auto& handlers = handlersIter->second;
+        auto [it, inserted] = _listIndices.try_emplace(
+            type, static_cast<uint32_t>(_lists.size()));
+        if (inserted) {
+            _lists.emplace_back();
+#ifdef EVENING_TRACE
+            _lists.back().stats = &_trace.type(type);
+#endif
+        }
+        return it->second;
+    }
+
+    Token addHandler(
+        uint32_t listIndex,
+        std::weak_ptr<const void> tracker,
+        bool tracked,
+        Handler handler)
+    {
+        auto& list = _lists[listIndex];
+
+        // Collect garbage before growing, so that handlers of rarely sent
+        // events do not pile up. Reserving twice the live size afterwards
+        // keeps the cost of these sweeps amortized constant.
+        if (list.dispatchDepth == 0 &&
+                list.entries.size() == list.entries.capacity()) {
+            compact(list);
+            list.entries.reserve(2 * list.entries.size());
+        }
 
-        for (auto handlerIt = handlers.begin(); handlerIt != handlers.end();) {
-            if ((*handlerIt)(event)) {
-                handlerIt++;
-            } else {
-                handlerIt = handlers.erase(handlerIt);
+        uint32_t slot = 0;
+        if (!list.freeSlots.empty()) {
+            slot = list.freeSlots.back();
+            list.freeSlots.pop_back();
+        } else {
+            slot = static_cast<uint32_t>(list.slots.size());
+            list.slots.emplace_back();
+        }
+
+        // Handlers added during dispatch wait in a separate vector, so the
+        // entries being iterated over are never reallocated. Their indices
+        // continue those of the main vector and stay valid after merging.
+        auto& target = list.dispatchDepth > 0 ? list.pending : list.entries;
+        list.slots[slot].entry =
+            static_cast<uint32_t>(list.entries.size() + list.pending.size());
+        target.push_back(Entry{
+            .handler = std::move(handler),
+            .tracker = std::move(tracker),
+            .slot = slot,
+            .tracked = tracked,
+        });
+
+        return Token{listIndex, slot, list.slots[slot].generation};
+    }
+
+    static Entry& entry(HandlerList& list, uint32_t index)
+    {
+        if (index < list.entries.size()) {
+            return list.entries[index];
+        }
+        return list.pending[index - list.entries.size()];
+    }
+
+    static void release(Entry& dead)
+    {
+        dead.handler = nullptr;
+        dead.tracker.reset();
+    }
+
+    static void kill(HandlerList& list, uint32_t index)
+    {
+        auto& dead = entry(list, index);
+        dead.alive = false;
+
+        // A handler may unsubscribe itself, so it is only destroyed once
+        // dispatch is over.
+        if (list.dispatchDepth > 0) {
+            list.killedDuringDispatch.push_back(index);
+        } else {
+            release(dead);
+        }
+
+        list.slots[dead.slot].generation++;
+        list.freeSlots.push_back(dead.slot);
+        list.deadCount++;
+    }
+
+    static void compact(HandlerList& list)
+    {
+        size_t live = 0;
+        for (size_t i = 0; i < list.entries.size(); i++) {
+            auto& current = list.entries[i];
+            if (current.alive && current.tracked &&
+                    current.tracker.expired()) {
+                kill(list, static_cast<uint32_t>(i));
+            }
+            if (!current.alive) {
+                continue;
+            }
+
+            if (live != i) {
+                list.entries[live] = std::move(current);
+            }
+            list.slots[list.entries[live].slot].entry =
+                static_cast<uint32_t>(live);
+            live++;
+        }
+        list.entries.erase(
+            list.entries.begin() + static_cast<std::ptrdiff_t>(live),
+            list.entries.end());
+        list.deadCount = 0;
+    }
+
+    // Marks the channel and a list as being dispatched. Ending the dispatch
+    // on destruction keeps both usable when a handler throws.
+    class Dispatch {
+    public:
+        Dispatch(Channel& channel, HandlerList& list)
+            : _channel(channel)
+            , _list(list)
+        {
+            _channel._dispatchDepth++;
+            _list.dispatchDepth++;
+        }
+
+        Dispatch(const Dispatch&) = delete;
+        Dispatch(Dispatch&&) = delete;
+        Dispatch& operator=(const Dispatch&) = delete;
+        Dispatch& operator=(Dispatch&&) = delete;
+
+        ~Dispatch()
+        {
+            _channel._dispatchDepth--;
+            _list.dispatchDepth--;
+            if (_list.dispatchDepth == 0) {
+                endDispatch(_list);
             }
         }
 
-        if (handlers.empty()) {
-            _handlers.erase(handlersIter);
+    private:
+        Channel& _channel;
+        HandlerList& _list;
+    };
+
+    static void endDispatch(HandlerList& list)
+    {
+        for (auto index : list.killedDuringDispatch) {
+            release(entry(list, index));
+        }
+        list.killedDuringDispatch.clear();
+
+        for (auto& added : list.pending) {
+            list.entries.push_back(std::move(added));
+        }
+        list.pending.clear();
+
+        if (list.deadCount * 2 > list.entries.size()) {
+            compact(list);
+        }
+    }
+
+    void sendEvent(const std::any& event, HandlerList& list)
+    {
+        const auto dispatch = Dispatch{*this, list};
+        for (size_t i = 0; i < list.entries.size(); i++) {
+            auto& current = list.entries[i];
+            if (!current.alive) {
+                continue;
+            }
+            if (current.tracked && current.tracker.expired()) {
+                kill(list, static_cast<uint32_t>(i));
+                continue;
+            }
+
+#ifdef EVENING_TRACE
+            auto start = Trace::Clock::now();
+            current.handler(event);
+            _trace.handlerCalled(*list.stats, start, Trace::Clock::now());
+#else
+            current.handler(event);
+#endif
         }
     }
 
     std::map<std::type_index, std::vector<std::any>> _events;
-    HandlerMap _handlers;
+    std::map<std::type_index, uint32_t> _listIndices;
+    std::deque<HandlerList> _lists;
+    Recorder* _recorder = nullptr;
+    // Handlers running across all lists, which is nonzero when events are
+    // pushed or sent from a handler
+    int _dispatchDepth = 0;
+#ifdef EVENING_TRACE
+    Trace _trace;
+#endif
 };
 
 class Subscriber {
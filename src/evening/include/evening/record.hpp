@@ -0,0 +1,207 @@
+#pragma once
+
+#include <evening.hpp>
+
+#include <fi/memory_mapped_file.hpp>
+#include <fi/writer.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <typeindex>
+#include <unordered_map>
+
+namespace evening {
+
+/*
+ * Event log layout, in native byte order:
+ *
+ *     magic "EVNG", uint32 version
+ *     records: uint8 kind, uint32 type id, uint32 payload size, payload
+ *
+ * Type ids are hashes of type names, so a log can only be replayed by a
+ * program built with the same compiler.
+ */
+namespace eventlog {
+
+inline constexpr std::array<char, 4> magic {'E', 'V', 'N', 'G'};
+inline constexpr uint32_t version = 1;
+
+inline uint32_t typeId(std::type_index type)
+{
+    // 32-bit FNV-1a
+    uint32_t hash = 2166136261U;
+    for (char c : std::string_view{type.name()}) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+} // namespace eventlog
+
+/**
+ * Writes events recorded from a channel into a binary log file.
+ */
+class FileRecorder : public Recorder {
+public:
+    explicit FileRecorder(const std::filesystem::path& path)
+        : _writer(path)
+    {
+        _writer.write(eventlog::magic);
+        _writer.write(eventlog::version);
+    }
+
+    void record(
+        Kind kind,
+        std::type_index type,
+        std::span<const std::byte> payload) override
+    {
+        _writer.write(kind);
+        _writer.write(eventlog::typeId(type));
+        _writer.write(static_cast<uint32_t>(payload.size()));
+        _writer.write(payload);
+    }
+
+    void flush()
+    {
+        _writer.flush();
+    }
+
+private:
+    fi::Writer _writer;
+};
+
+/**
+ * Plays a log written by FileRecorder back into a channel as fast as
+ * possible. Every event type present in the log must be registered with
+ * add().
+ */
+class Replayer {
+public:
+    struct Stats {
+        size_t events = 0;
+        size_t delivers = 0;
+        size_t bytes = 0;
+        std::chrono::steady_clock::duration duration{};
+
+        [[nodiscard]] double eventsPerSecond() const
+        {
+            return static_cast<double>(events) /
+                std::chrono::duration<double>(duration).count();
+        }
+    };
+
+    template <class Event>
+    requires std::is_trivially_copyable_v<Event>
+    void add()
+    {
+        _players[eventlog::typeId(typeid(Event))] = [] (
+                Channel& channel,
+                Recorder::Kind kind,
+                std::span<const std::byte> payload) {
+            if (payload.size() != sizeof(Event)) {
+                throw std::runtime_error{
+                    "Replayer: payload size mismatch for event type " +
+                    std::string{typeid(Event).name()}};
+            }
+
+            // Payloads in the log are unaligned, and Event may not be
+            // default-constructible
+            alignas(Event) std::array<std::byte, sizeof(Event)> storage {};
+            std::memcpy(storage.data(), payload.data(), sizeof(Event));
+            const auto& event = *std::launder(
+                reinterpret_cast<const Event*>(storage.data()));
+
+            if (kind == Recorder::Kind::Push) {
+                channel.push(event);
+            } else {
+                channel.send(event);
+            }
+        };
+    }
+
+    Stats replay(const std::filesystem::path& path, Channel& channel) const
+    {
+        auto file = fi::MemoryMappedFile{path};
+        auto data = file.span();
+
+        auto take = [&data, &path] (size_t size) {
+            if (data.size() < size) {
+                throw std::runtime_error{
+                    "Replayer: truncated event log: " + path.string()};
+            }
+            auto result = data.first(size);
+            data = data.subspan(size);
+            return result;
+        };
+        auto read = [&take] <class T> (T& value) {
+            std::memcpy(&value, take(sizeof(T)).data(), sizeof(T));
+        };
+
+        auto fileMagic = std::array<char, 4>{};
+        auto fileVersion = uint32_t{0};
+        read(fileMagic);
+        read(fileVersion);
+        if (fileMagic != eventlog::magic || fileVersion != eventlog::version) {
+            throw std::runtime_error{
+                "Replayer: not an event log: " + path.string()};
+        }
+
+        auto stats = Stats{};
+        auto start = std::chrono::steady_clock::now();
+        while (!data.empty()) {
+            auto kind = Recorder::Kind{};
+            auto typeId = uint32_t{0};
+            auto size = uint32_t{0};
+            read(kind);
+            read(typeId);
+            read(size);
+            auto payload = take(size);
+
+            if (kind != Recorder::Kind::Send &&
+                    kind != Recorder::Kind::Push &&
+                    kind != Recorder::Kind::Deliver) {
+                throw std::runtime_error{
+                    "Replayer: corrupt event log: " + path.string()};
+            }
+
+            if (kind == Recorder::Kind::Deliver) {
+                channel.deliver();
+                stats.delivers++;
+                continue;
+            }
+
+            auto it = _players.find(typeId);
+            if (it == _players.end()) {
+                throw std::runtime_error{
+                    "Replayer: event type is not registered: " +
+                    std::to_string(typeId)};
+            }
+            it->second(channel, kind, payload);
+            stats.events++;
+            stats.bytes += size;
+        }
+        stats.duration = std::chrono::steady_clock::now() - start;
+
+        return stats;
+    }
+
+private:
+    using Player = std::function<void(
+        Channel&, Recorder::Kind, std::span<const std::byte>)>;
+
+    std::unordered_map<uint32_t, Player> _players;
+};
+
+} // namespace evening
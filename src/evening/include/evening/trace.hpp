@@ -0,0 +1,206 @@
+#pragma once
+
+#include <tempo/chrome_trace.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <typeindex>
+#include <vector>
+
+#if __has_include(<cxxabi.h>)
+#include <cxxabi.h>
+#endif
+
+namespace evening {
+
+/**
+ * Event statistics collected by a channel when compiled with EVENING_TRACE.
+ * Counters accumulate until reset(), so resetting once per frame gives
+ * per-frame numbers.
+ *
+ * The macro changes the layout of Channel, which is defined in the header,
+ * so every translation unit of a program must agree on it. The evening
+ * target defines it for all its users when the EVENING_TRACE option is on.
+ */
+class Trace {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Bucket i counts handler calls that took [2^(i-1), 2^i) nanoseconds,
+    // except the last one, which counts all calls from 2^(i-1) on.
+    static constexpr size_t histogramSize = 32;
+
+    struct TypeStats {
+        std::string name;
+        uint64_t pushed = 0;
+        uint64_t sent = 0;
+        uint64_t delivered = 0;
+        uint64_t handlerCalls = 0;
+        size_t queueHighWater = 0;
+        Clock::duration handlerTime{};
+        std::array<uint64_t, histogramSize> handlerHistogram{};
+    };
+
+    struct Span {
+        const TypeStats* type = nullptr;
+        Clock::time_point start;
+        Clock::duration duration{};
+    };
+
+    TypeStats& type(std::type_index typeIndex)
+    {
+        auto [it, inserted] = _types.try_emplace(typeIndex);
+        if (inserted) {
+            it->second.name = typeName(typeIndex);
+        }
+        return it->second;
+    }
+
+    void pushed(TypeStats& stats, size_t queueSize)
+    {
+        stats.pushed++;
+        if (queueSize > stats.queueHighWater) {
+            stats.queueHighWater = queueSize;
+        }
+    }
+
+    void handlerCalled(
+        TypeStats& stats, Clock::time_point start, Clock::time_point end)
+    {
+        auto duration = end - start;
+        stats.handlerCalls++;
+        stats.handlerTime += duration;
+
+        auto nanoseconds = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(duration)
+                .count());
+        auto bucket = static_cast<size_t>(std::bit_width(nanoseconds));
+        stats.handlerHistogram[std::min(bucket, histogramSize - 1)]++;
+
+        if (_spans.size() < _spanLimit) {
+            _spans.push_back(Span{
+                .type = &stats,
+                .start = start,
+                .duration = duration,
+            });
+        }
+    }
+
+    /**
+     * Limit the number of handler spans kept for the Chrome trace. Counters
+     * are not affected by the limit.
+     */
+    void spanLimit(size_t limit)
+    {
+        _spanLimit = limit;
+    }
+
+    [[nodiscard]] const std::map<std::type_index, TypeStats>& types() const
+    {
+        return _types;
+    }
+
+    [[nodiscard]] const std::vector<Span>& spans() const
+    {
+        return _spans;
+    }
+
+    void reset()
+    {
+        for (auto& [typeIndex, stats] : _types) {
+            auto name = std::move(stats.name);
+            stats = TypeStats{};
+            stats.name = std::move(name);
+        }
+        _spans.clear();
+        _start = Clock::now();
+    }
+
+    void writeJson(std::ostream& output) const
+    {
+        output << "{\"types\":[";
+        bool firstType = true;
+        for (const auto& [typeIndex, stats] : _types) {
+            output << (firstType ? "" : ",");
+            firstType = false;
+
+            output << "{\"name\":";
+            tempo::writeJsonString(output, stats.name);
+            output <<
+                ",\"pushed\":" << stats.pushed <<
+                ",\"sent\":" << stats.sent <<
+                ",\"delivered\":" << stats.delivered <<
+                ",\"handlerCalls\":" << stats.handlerCalls <<
+                ",\"queueHighWater\":" << stats.queueHighWater <<
+                ",\"handlerTimeNs\":" <<
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    stats.handlerTime).count() <<
+                ",\"handlerHistogram\":[";
+
+            bool firstBucket = true;
+            for (size_t i = 0; i < histogramSize; i++) {
+                if (stats.handlerHistogram.at(i) == 0) {
+                    continue;
+                }
+                output << (firstBucket ? "" : ",");
+                firstBucket = false;
+                if (i + 1 < histogramSize) {
+                    output << "{\"belowNs\":" << (uint64_t{1} << i);
+                } else {
+                    output << "{\"atLeastNs\":" << (uint64_t{1} << (i - 1));
+                }
+                output <<
+                    ",\"count\":" << stats.handlerHistogram.at(i) << "}";
+            }
+            output << "]}";
+        }
+        output << "]}";
+    }
+
+    /**
+     * Write handler spans in the Chrome trace event format, which can be
+     * opened in chrome://tracing or Perfetto.
+     */
+    void writeChromeTrace(std::ostream& output) const
+    {
+        auto trace = tempo::ChromeTraceWriter{output, "evening"};
+        for (const auto& span : _spans) {
+            trace.write(tempo::ChromeTraceWriter::Event{
+                .name = span.type->name,
+                .start = span.start - _start,
+                .duration = span.duration,
+            });
+        }
+    }
+
+private:
+    static std::string typeName(std::type_index typeIndex)
+    {
+#if __has_include(<cxxabi.h>)
+        int status = 0;
+        auto demangled = std::unique_ptr<char, void(*)(void*)>{
+            abi::__cxa_demangle(typeIndex.name(), nullptr, nullptr, &status),
+            std::free};
+        if (status == 0 && demangled) {
+            return demangled.get();
+        }
+#endif
+        return typeIndex.name();
+    }
+
+    std::map<std::type_index, TypeStats> _types;
+    std::vector<Span> _spans;
+    size_t _spanLimit = size_t{1} << 16;
+    Clock::time_point _start = Clock::now();
+};
+
+} // namespace evening
@@ -0,0 +1,193 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <evening.hpp>
+#include <evening/record.hpp>
+
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace ev = evening;
+
+namespace {
+
+struct Move {
+    int id;
+    float x;
+    float y;
+};
+
+struct Hit {
+    int id;
+};
+
+struct Text {
+    std::string text;
+};
+
+} // namespace
+
+TEST_CASE("Record and replay event stream", "[record]")
+{
+    const auto path =
+        std::filesystem::temp_directory_path() / "evening-record-test.log";
+
+    {
+        ev::Channel channel;
+        ev::FileRecorder recorder{path};
+        channel.recorder(&recorder);
+
+        channel.push(Move{.id = 1, .x = 1.f, .y = 2.f});
+        channel.makePush<Hit>(Hit{2});
+        channel.push(Text{"not recorded"});
+        channel.deliver();
+        channel.send(Move{.id = 3, .x = 4.f, .y = 5.f});
+
+        channel.recorder(nullptr);
+        channel.send(Hit{4});
+    }
+
+    ev::Channel channel;
+    std::vector<int> moves;
+    std::vector<int> hits;
+    auto moveSubscription = channel.subscribe<Move>(
+        [&moves] (const Move& move) { moves.push_back(move.id); });
+    auto hitSubscription = channel.subscribe<Hit>(
+        [&hits] (const Hit& hit) { hits.push_back(hit.id); });
+
+    ev::Replayer replayer;
+    replayer.add<Move>();
+    replayer.add<Hit>();
+    auto stats = replayer.replay(path, channel);
+
+    REQUIRE(stats.events == 3);
+    REQUIRE(stats.delivers == 1);
+    REQUIRE(stats.bytes == 2 * sizeof(Move) + sizeof(Hit));
+    REQUIRE(moves == std::vector<int>{1, 3});
+    REQUIRE(hits == std::vector<int>{2});
+
+    SECTION("Unregistered event type") {
+        ev::Replayer partial;
+        partial.add<Move>();
+        REQUIRE_THROWS(partial.replay(path, channel));
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Events caused by handlers are not recorded", "[record]")
+{
+    const auto path =
+        std::filesystem::temp_directory_path() / "evening-nested-test.log";
+
+    // Every move is answered with a hit sent right away and one pushed for
+    // the next delivery, which a replay must produce again rather than read
+    // from the log
+    auto run = [] (ev::Channel& channel, std::vector<int>& hits) {
+        return std::vector{
+            channel.subscribe<Move>([&channel] (const Move& move) {
+                channel.send(Hit{move.id});
+                channel.push(Hit{-move.id});
+            }),
+            channel.subscribe<Hit>(
+                [&hits] (const Hit& hit) { hits.push_back(hit.id); }),
+        };
+    };
+
+    std::vector<int> recordedHits;
+    {
+        ev::Channel channel;
+        auto subscriptions = run(channel, recordedHits);
+        ev::FileRecorder recorder{path};
+        channel.recorder(&recorder);
+
+        channel.send(Move{.id = 1, .x = 0.f, .y = 0.f});
+        channel.push(Move{.id = 2, .x = 0.f, .y = 0.f});
+        channel.deliver();
+        channel.deliver();
+    }
+
+    ev::Channel channel;
+    std::vector<int> replayedHits;
+    auto subscriptions = run(channel, replayedHits);
+    ev::Replayer replayer;
+    replayer.add<Move>();
+    replayer.add<Hit>();
+    auto stats = replayer.replay(path, channel);
+
+    REQUIRE(stats.events == 2);
+    REQUIRE(stats.delivers == 2);
+    REQUIRE(recordedHits == std::vector<int>{1, -1, 2, -2});
+    REQUIRE(replayedHits == recordedHits);
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Recording goes on after a handler throws", "[record]")
+{
+    const auto path =
+        std::filesystem::temp_directory_path() / "evening-throw-test.log";
+
+    {
+        ev::Channel channel;
+        auto subscription = channel.subscribe<Hit>([] (const Hit& hit) {
+            if (hit.id == 1) {
+                throw std::runtime_error{"handler failed"};
+            }
+        });
+        ev::FileRecorder recorder{path};
+        channel.recorder(&recorder);
+
+        REQUIRE_THROWS_AS(channel.send(Hit{1}), std::runtime_error);
+        channel.send(Hit{2});
+    }
+
+    ev::Channel channel;
+    std::vector<int> hits;
+    auto subscription = channel.subscribe<Hit>(
+        [&hits] (const Hit& hit) { hits.push_back(hit.id); });
+    ev::Replayer replayer;
+    replayer.add<Hit>();
+    auto stats = replayer.replay(path, channel);
+
+    REQUIRE(stats.events == 2);
+    REQUIRE(hits == std::vector<int>{1, 2});
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Replaying a log with an unknown record kind fails", "[record]")
+{
+    const auto path =
+        std::filesystem::temp_directory_path() / "evening-corrupt-test.log";
+
+    {
+        ev::Channel channel;
+        ev::FileRecorder recorder{path};
+        channel.recorder(&recorder);
+        channel.send(Hit{1});
+    }
+
+    // The kind of the first record follows the magic and the version
+    {
+        std::fstream file{
+            path, std::ios::in | std::ios::out | std::ios::binary};
+        file.seekp(8);
+        file.put(static_cast<char>(7));
+    }
+
+    ev::Channel channel;
+    int hits = 0;
+    auto subscription =
+        channel.subscribe<Hit>([&hits] (const Hit&) { hits++; });
+    ev::Replayer replayer;
+    replayer.add<Hit>();
+
+    REQUIRE_THROWS(replayer.replay(path, channel));
+    REQUIRE(hits == 0);
+
+    std::filesystem::remove(path);
+}
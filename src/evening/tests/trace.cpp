@@ -0,0 +1,91 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <evening.hpp>
+
+#include <chrono>
+#include <sstream>
+#include <string>
+
+namespace ev = evening;
+
+namespace {
+
+struct Ping {};
+struct Pong {};
+
+} // namespace
+
+TEST_CASE("Count events per type", "[trace]")
+{
+    ev::Channel channel;
+    int pings = 0;
+    auto subscription = channel.subscribe<Ping>([&pings] (const Ping&) {
+        pings++;
+    });
+
+    channel.push(Ping{});
+    channel.push(Ping{});
+    channel.makePush<Ping>();
+    channel.push(Pong{});
+    channel.send(Ping{});
+    channel.deliver();
+    REQUIRE(pings == 4);
+
+    const auto& types = channel.trace().types();
+    const auto& ping = types.at(typeid(Ping));
+    REQUIRE(ping.pushed == 3);
+    REQUIRE(ping.sent == 1);
+    REQUIRE(ping.delivered == 3);
+    REQUIRE(ping.handlerCalls == 4);
+    REQUIRE(ping.queueHighWater == 3);
+
+    uint64_t histogramTotal = 0;
+    for (auto count : ping.handlerHistogram) {
+        histogramTotal += count;
+    }
+    REQUIRE(histogramTotal == 4);
+    REQUIRE(channel.trace().spans().size() == 4);
+
+    const auto& pong = types.at(typeid(Pong));
+    REQUIRE(pong.pushed == 1);
+    REQUIRE(pong.delivered == 1);
+    REQUIRE(pong.handlerCalls == 0);
+
+    channel.trace().reset();
+    REQUIRE(channel.trace().types().at(typeid(Ping)).pushed == 0);
+    REQUIRE(channel.trace().spans().empty());
+}
+
+TEST_CASE("Dump statistics", "[trace]")
+{
+    ev::Channel channel;
+    auto subscription = channel.subscribe<Ping>([] (const Ping&) {});
+    channel.send(Ping{});
+
+    auto json = std::ostringstream{};
+    channel.trace().writeJson(json);
+    REQUIRE(json.str().find("\"handlerCalls\":1") != std::string::npos);
+
+    auto chromeTrace = std::ostringstream{};
+    channel.trace().writeChromeTrace(chromeTrace);
+    REQUIRE(chromeTrace.str().starts_with("{\"traceEvents\":[{"));
+    REQUIRE(chromeTrace.str().find("\"ph\":\"X\"") != std::string::npos);
+}
+
+TEST_CASE("The slowest histogram bucket is open-ended", "[trace]")
+{
+    auto trace = ev::Trace{};
+    auto& stats = trace.type(typeid(Ping));
+    const auto start = ev::Trace::Clock::now();
+    trace.handlerCalled(stats, start, start + std::chrono::milliseconds{1});
+    trace.handlerCalled(stats, start, start + std::chrono::seconds{5});
+    REQUIRE(stats.handlerHistogram.back() == 1);
+
+    auto json = std::ostringstream{};
+    trace.writeJson(json);
+    REQUIRE(json.str().find("{\"belowNs\":1048576,\"count\":1}") !=
+        std::string::npos);
+    REQUIRE(json.str().find("{\"atLeastNs\":1073741824,\"count\":1}") !=
+        std::string::npos);
+    REQUIRE(json.str().find("\"belowNs\":2147483648") == std::string::npos);
+}
@@ -0,0 +1,149 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <evening.hpp>
+
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace ev = evening;
+
+namespace {
+
+struct Event {};
+struct RareEvent {};
+
+} // namespace
+
+TEST_CASE("Unsubscribe with token", "[unsubscribe]")
+{
+    ev::Channel channel;
+    int counter = 0;
+
+    auto token = channel.listen<Event>([&counter] (const Event&) {
+        counter++;
+    });
+    REQUIRE(token.valid());
+
+    channel.send(Event{});
+    REQUIRE(counter == 1);
+
+    REQUIRE(channel.unsubscribe(token));
+    channel.send(Event{});
+    REQUIRE(counter == 1);
+
+    SECTION("Stale token is rejected") {
+        REQUIRE(!channel.unsubscribe(token));
+        REQUIRE(!channel.unsubscribe(ev::Token{}));
+    }
+
+    SECTION("Reused slot is not affected by stale token") {
+        auto newToken = channel.listen<Event>([&counter] (const Event&) {
+            counter += 10;
+        });
+        REQUIRE(!channel.unsubscribe(token));
+        channel.send(Event{});
+        REQUIRE(counter == 11);
+        REQUIRE(channel.unsubscribe(newToken));
+    }
+}
+
+TEST_CASE("Unsubscribe keeps order of remaining handlers", "[unsubscribe]")
+{
+    ev::Channel channel;
+    std::vector<int> calls;
+
+    std::vector<ev::Token> tokens;
+    for (int i = 0; i < 10; i++) {
+        tokens.push_back(channel.listen<Event>([&calls, i] (const Event&) {
+            calls.push_back(i);
+        }));
+    }
+    for (int i = 0; i < 10; i += 2) {
+        REQUIRE(channel.unsubscribe(tokens.at(i)));
+    }
+
+    channel.send(Event{});
+    REQUIRE(calls == std::vector<int>{1, 3, 5, 7, 9});
+
+    calls.clear();
+    REQUIRE(channel.unsubscribe(tokens.at(5)));
+    channel.send(Event{});
+    REQUIRE(calls == std::vector<int>{1, 3, 7, 9});
+}
+
+TEST_CASE("Unsubscribe during dispatch", "[unsubscribe]")
+{
+    ev::Channel channel;
+    int first = 0;
+    int second = 0;
+
+    ev::Token secondToken;
+    ev::Token firstToken = channel.listen<Event>(
+        [&] (const Event&) {
+            first++;
+            channel.unsubscribe(firstToken);
+            channel.unsubscribe(secondToken);
+            channel.listen<Event>([&second] (const Event&) {
+                second += 10;
+            });
+        });
+    secondToken = channel.listen<Event>([&second] (const Event&) {
+        second++;
+    });
+
+    channel.send(Event{});
+    REQUIRE(first == 1);
+    REQUIRE(second == 0);
+
+    channel.send(Event{});
+    REQUIRE(first == 1);
+    REQUIRE(second == 10);
+}
+
+TEST_CASE("Expired trackers are collected without dispatch", "[unsubscribe]")
+{
+    ev::Channel channel;
+    auto state = std::make_shared<int>(0);
+
+    for (int i = 0; i < 1000; i++) {
+        auto subscription = channel.subscribe<RareEvent>(
+            [state] (const RareEvent&) { (*state)++; });
+    }
+    REQUIRE(state.use_count() <= 2);
+
+    channel.compact();
+    REQUIRE(state.use_count() == 1);
+
+    auto tracker = std::make_shared<char>();
+    channel.subscribe<RareEvent>(tracker, [state] (const RareEvent&) {
+        (*state)++;
+    });
+    channel.send(RareEvent{});
+    REQUIRE(*state == 1);
+}
+
+TEST_CASE("A throwing handler leaves the channel usable", "[unsubscribe]")
+{
+    ev::Channel channel;
+    int thrown = 0;
+    int added = 0;
+
+    auto throwing = channel.listen<Event>([&thrown] (const Event&) {
+        thrown++;
+        throw std::runtime_error{"handler failed"};
+    });
+    REQUIRE_THROWS_AS(channel.send(Event{}), std::runtime_error);
+    REQUIRE(channel.unsubscribe(throwing));
+
+    // Handlers added afterwards are called, as they would not be if the
+    // channel still took the failed dispatch for one in progress
+    auto token = channel.listen<Event>([&added] (const Event&) {
+        added++;
+    });
+    channel.send(Event{});
+    channel.send(Event{});
+    REQUIRE(thrown == 1);
+    REQUIRE(added == 2);
+    REQUIRE(channel.unsubscribe(token));
+}
@@ -0,0 +1,290 @@
+#include <fi/archive.hpp>
+
+#include <fi/writer.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace fs = std::filesystem;
+
+namespace fi {
+
+static_assert(
+    std::endian::native == std::endian::little,
+    "Archive: records are read in native order");
+static_assert(sizeof(internals::ArchiveHeader) == 40);
+static_assert(sizeof(internals::ArchiveEntry) == 32);
+
+namespace internals {
+
+uint64_t archiveHash(std::string_view name)
+{
+    uint64_t hash = 0xcbf29ce484222325;
+    for (char c : name) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 0x100000001b3;
+    }
+    return hash;
+}
+
+} // namespace internals
+
+namespace {
+
+using internals::ArchiveEntry;
+using internals::ArchiveHeader;
+
+// Records are copied out of the mapping, which makes no promise about their
+// alignment
+template <class T>
+T load(std::span<const std::byte> bytes, size_t offset)
+{
+    auto value = T{};
+    std::memcpy(&value, bytes.data() + offset, sizeof(T));
+    return value;
+}
+
+bool fits(uint64_t offset, uint64_t size, uint64_t limit)
+{
+    return offset <= limit && size <= limit - offset;
+}
+
+uint64_t alignUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+Archive::Archive(const fs::path& path)
+    : _file(path)
+{
+    auto fail = [&path] (const std::string& message) {
+        return std::runtime_error{"Archive: " + message + ": " + path.string()};
+    };
+
+    auto bytes = _file.span();
+    if (bytes.size() < sizeof(ArchiveHeader)) {
+        throw fail("file too small");
+    }
+    _header = load<ArchiveHeader>(bytes, 0);
+    if (_header.magic != internals::archiveMagic) {
+        throw fail("not an archive");
+    }
+    if (_header.version != internals::archiveVersion) {
+        throw fail("unsupported version " + std::to_string(_header.version));
+    }
+    if (!std::has_single_bit(_header.bucketCount) ||
+            _header.bucketCount < _header.entryCount) {
+        throw fail("bad hash table");
+    }
+
+    // Bounds are checked once here, so that lookups need not
+    _bucketsOffset =
+        sizeof(ArchiveHeader) + _header.entryCount * sizeof(ArchiveEntry);
+    auto tablesEnd =
+        _bucketsOffset + uint64_t{_header.bucketCount} * sizeof(uint32_t);
+    if (tablesEnd > bytes.size() ||
+            _header.namesOffset < tablesEnd ||
+            !fits(_header.namesOffset, _header.namesSize, bytes.size())) {
+        throw fail("truncated tables");
+    }
+    for (size_t i = 0; i < _header.entryCount; i++) {
+        auto entry = record(i);
+        if (!fits(entry.offset, entry.size, bytes.size()) ||
+                !fits(entry.nameOffset, entry.nameSize, _header.namesSize)) {
+            throw fail("entry out of bounds");
+        }
+    }
+    for (size_t i = 0; i < _header.bucketCount; i++) {
+        auto index =
+            load<uint32_t>(bytes, _bucketsOffset + i * sizeof(uint32_t));
+        if (index > _header.entryCount) {
+            throw fail("bad hash table");
+        }
+    }
+}
+
+size_t Archive::size() const
+{
+    return _header.entryCount;
+}
+
+bool Archive::empty() const
+{
+    return _header.entryCount == 0;
+}
+
+Archive::Entry Archive::entry(size_t index) const
+{
+    if (index >= size()) {
+        throw std::out_of_range{"Archive: entry index out of range"};
+    }
+    auto entry = record(index);
+    return Entry{
+        .name = name(entry),
+        .data = _file.span().subspan(entry.offset, entry.size),
+    };
+}
+
+bool Archive::contains(std::string_view name) const
+{
+    return find(name).has_value();
+}
+
+std::optional<std::span<const std::byte>> Archive::find(
+    std::string_view name) const
+{
+    // Linear probing; the table is at most half full, so chains are short
+    auto bytes = _file.span();
+    auto hash = internals::archiveHash(name);
+    auto mask = _header.bucketCount - 1;
+    auto bucket = static_cast<uint32_t>(hash) & mask;
+    for (uint32_t probe = 0; probe < _header.bucketCount; probe++) {
+        auto index = load<uint32_t>(
+            bytes, _bucketsOffset + bucket * sizeof(uint32_t));
+        if (index == 0) {
+            return std::nullopt;
+        }
+        auto entry = record(index - 1);
+        if (entry.hash == hash && this->name(entry) == name) {
+            return bytes.subspan(entry.offset, entry.size);
+        }
+        bucket = (bucket + 1) & mask;
+    }
+    return std::nullopt;
+}
+
+std::span<const std::byte> Archive::at(std::string_view name) const
+{
+    if (auto data = find(name)) {
+        return *data;
+    }
+    throw std::out_of_range{"Archive: no entry: " + std::string{name}};
+}
+
+ArchiveEntry Archive::record(size_t index) const
+{
+    return load<ArchiveEntry>(
+        _file.span(), sizeof(ArchiveHeader) + index * sizeof(ArchiveEntry));
+}
+
+std::string_view Archive::name(const ArchiveEntry& record) const
+{
+    auto names = _file.span().subspan(_header.namesOffset, _header.namesSize);
+    return {
+        reinterpret_cast<const char*>(names.data()) + record.nameOffset,
+        record.nameSize};
+}
+
+void ArchiveBuilder::add(std::string name, fs::path path)
+{
+    _sources.push_back(
+        Source{.name = std::move(name), .path = std::move(path)});
+}
+
+void ArchiveBuilder::add(std::string name, std::vector<std::byte> data)
+{
+    _sources.push_back(
+        Source{.name = std::move(name), .data = std::move(data)});
+}
+
+void ArchiveBuilder::write(const fs::path& path, size_t alignment) const
+{
+    if (!std::has_single_bit(alignment)) {
+        throw std::invalid_argument{
+            "ArchiveBuilder: alignment is not a power of two"};
+    }
+    if (_sources.size() >= std::numeric_limits<uint32_t>::max() / 2) {
+        throw std::length_error{"ArchiveBuilder: too many entries"};
+    }
+
+    auto sources = std::vector<const Source*>{};
+    for (const auto& source : _sources) {
+        sources.push_back(&source);
+    }
+    auto byName = [] (const Source* source) -> const std::string& {
+        return source->name;
+    };
+    std::ranges::sort(sources, {}, byName);
+    auto duplicate = std::ranges::adjacent_find(sources, {}, byName);
+    if (duplicate != sources.end()) {
+        throw std::invalid_argument{
+            "ArchiveBuilder: duplicate entry: " + (*duplicate)->name};
+    }
+
+    // Files are mapped for the copy, and their sizes are needed for the
+    // layout before any data is written
+    auto files = std::vector<MemoryMappedFile>{};
+    auto contents = std::vector<std::span<const std::byte>>{};
+    files.reserve(sources.size());
+    for (const auto* source : sources) {
+        if (source->path.empty()) {
+            contents.emplace_back(source->data);
+        } else {
+            contents.push_back(files.emplace_back(source->path).span());
+        }
+    }
+
+    auto header = ArchiveHeader{};
+    header.entryCount = static_cast<uint32_t>(sources.size());
+    header.bucketCount =
+        std::bit_ceil(std::max<uint32_t>(2 * header.entryCount, 1));
+    header.alignment = static_cast<uint32_t>(alignment);
+    header.namesOffset = sizeof(ArchiveHeader) +
+        header.entryCount * sizeof(ArchiveEntry) +
+        header.bucketCount * sizeof(uint32_t);
+
+    auto entries = std::vector<ArchiveEntry>(sources.size());
+    auto names = std::string{};
+    for (size_t i = 0; i < sources.size(); i++) {
+        const auto& name = sources[i]->name;
+        if (names.size() + name.size() > std::numeric_limits<uint32_t>::max()) {
+            throw std::length_error{"ArchiveBuilder: names too long"};
+        }
+        entries[i].hash = internals::archiveHash(name);
+        entries[i].nameOffset = static_cast<uint32_t>(names.size());
+        entries[i].nameSize = static_cast<uint32_t>(name.size());
+        names += name;
+    }
+    header.namesSize = names.size();
+
+    auto offset = header.namesOffset + header.namesSize;
+    for (size_t i = 0; i < sources.size(); i++) {
+        offset = alignUp(offset, alignment);
+        entries[i].offset = offset;
+        entries[i].size = contents[i].size();
+        offset += contents[i].size();
+    }
+
+    auto buckets = std::vector<uint32_t>(header.bucketCount);
+    auto mask = header.bucketCount - 1;
+    for (uint32_t i = 0; i < header.entryCount; i++) {
+        auto bucket = static_cast<uint32_t>(entries[i].hash) & mask;
+        while (buckets[bucket] != 0) {
+            bucket = (bucket + 1) & mask;
+        }
+        buckets[bucket] = i + 1;
+    }
+
+    auto writer = Writer{path};
+    writer.write(header);
+    writer.write(std::as_bytes(std::span{entries}));
+    writer.write(std::as_bytes(std::span{buckets}));
+    writer.write(std::as_bytes(std::span{names}));
+
+    const auto padding = std::vector<std::byte>(alignment);
+    auto position = header.namesOffset + header.namesSize;
+    for (size_t i = 0; i < sources.size(); i++) {
+        writer.write(std::span{padding}.first(entries[i].offset - position));
+        writer.write(contents[i]);
+        position = entries[i].offset + entries[i].size;
+    }
+    writer.flush();
+}
+
+} // namespace fi
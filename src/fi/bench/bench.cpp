@@ -0,0 +1,181 @@
+#include <fi.hpp>
+
+#include <arg.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+using BenchClock = std::chrono::steady_clock;
+
+struct Result {
+    std::string name;
+    size_t threads = 0;
+    size_t files = 0;
+    double megabytesPerSecond = 0;
+};
+
+fs::path createWorkDirectory(const fs::path& parent)
+{
+    fs::create_directories(parent);
+    auto random = std::random_device{};
+    auto directory = fs::path{};
+    do {
+        directory = parent / ("fi-bench-" + std::to_string(random()));
+    } while (!fs::create_directory(directory));
+    return directory;
+}
+
+std::vector<fs::path> createFiles(
+    const fs::path& directory, size_t count, size_t size)
+{
+    auto data = std::vector<std::byte>(size);
+    auto paths = std::vector<fs::path>{};
+    for (size_t i = 0; i < count; i++) {
+        for (size_t j = 0; j < size; j++) {
+            data[j] = static_cast<std::byte>(i + j);
+        }
+        auto& path = paths.emplace_back(
+            directory / ("file-" + std::to_string(i) + ".bin"));
+        fi::write(path, std::span<const std::byte>{data});
+    }
+    return paths;
+}
+
+// Drop the files from the page cache, where the system allows it, so that
+// reads go to the disk
+void evict(const std::vector<fs::path>& paths)
+{
+#ifdef __linux__
+    for (const auto& path : paths) {
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC); // NOLINT
+        if (fd != -1) {
+            fdatasync(fd);
+            posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+            close(fd);
+        }
+    }
+#endif
+}
+
+double megabytesPerSecond(size_t bytes, BenchClock::duration duration)
+{
+    return static_cast<double>(bytes) / 1e6 /
+        std::chrono::duration<double>(duration).count();
+}
+
+void benchSerial(
+    const std::vector<fs::path>& paths, bool cold, std::vector<Result>& results)
+{
+    if (cold) {
+        evict(paths);
+    }
+    size_t bytes = 0;
+    auto start = BenchClock::now();
+    for (const auto& path : paths) {
+        bytes += fi::read<std::byte>(path).size();
+    }
+    results.push_back(Result{
+        .name = cold ? "serial-cold" : "serial-warm",
+        .threads = 1,
+        .files = paths.size(),
+        .megabytesPerSecond =
+            megabytesPerSecond(bytes, BenchClock::now() - start),
+    });
+}
+
+void benchReadMany(
+    const std::vector<fs::path>& paths,
+    size_t threads,
+    bool cold,
+    std::vector<Result>& results)
+{
+    if (cold) {
+        evict(paths);
+    }
+    auto stats = fi::readMany(paths, [] (size_t, std::vector<std::byte>) {},
+        threads);
+    results.push_back(Result{
+        .name = cold ? "readMany-cold" : "readMany-warm",
+        .threads = threads,
+        .files = paths.size(),
+        .megabytesPerSecond = stats.bytesPerSecond() / 1e6,
+    });
+}
+
+void writeJson(std::ostream& output, const std::vector<Result>& results)
+{
+    output << "{\"benchmarks\":[";
+    bool first = true;
+    for (const auto& result : results) {
+        output << (first ? "\n" : ",\n");
+        first = false;
+        output <<
+            "  {\"name\":\"" << result.name << "\"" <<
+            ",\"threads\":" << result.threads <<
+            ",\"files\":" << result.files <<
+            ",\"MBps\":" << result.megabytesPerSecond << "}";
+    }
+    output << "\n]}\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    arg::helpKeys("-h", "--help");
+    auto fileCount = arg::option<size_t>()
+        .keys("-n", "--file-count")
+        .defaultValue(500)
+        .help("number of files to read");
+    auto fileSize = arg::option<size_t>()
+        .keys("-s", "--file-size")
+        .defaultValue(64 * 1024)
+        .help("size of each file in bytes");
+    auto directory = arg::option<std::string>()
+        .keys("-d", "--directory")
+        .metavar("DIR")
+        .defaultValue(fs::temp_directory_path().string())
+        .help("directory on the disk to measure, to create the files under");
+    auto outputPath = arg::option<std::string>()
+        .keys("-o", "--output")
+        .metavar("PATH")
+        .help("write JSON to a file instead of standard output");
+    arg::parse(argc, argv);
+
+    // Files go into a new directory of their own, which is all that is
+    // removed afterwards
+    const auto workDirectory = createWorkDirectory(*directory);
+    const auto paths = createFiles(workDirectory, *fileCount, *fileSize);
+
+    auto results = std::vector<Result>{};
+    for (bool cold : {true, false}) {
+        benchSerial(paths, cold, results);
+        for (size_t threads : {2, 4, 8, 16}) {
+            benchReadMany(paths, threads, cold, results);
+        }
+    }
+    fs::remove_all(workDirectory);
+
+    if (outputPath.isSet()) {
+        auto output = std::ofstream{*outputPath};
+        writeJson(output, results);
+    } else {
+        writeJson(std::cout, results);
+    }
+}
@@ -1,5 +1,7 @@
 #include <fi/fs.hpp>
 
+#include <fi/reader.hpp>
+
 #include <concepts>
 #include <fstream>
 #include <stdexcept>
@@ -80,22 +82,28 @@ fs::path globalConfigPath()
 #endif
 }
 
+// One open, one fstat and reads straight into the result, without a stream
+// buffer in between
 template <class T>
 std::vector<T> read(const fs::path& path)
 {
-    if (!fs::exists(path)) {
-        throw std::runtime_error{"file does not exist: " + path.string()};
-    }
-    auto input = std::ifstream{};
-    input.exceptions(std::ios::badbit | std::ios::failbit);
-    input.open(path, std::ios::binary | std::ios::ate);
-    const auto fileSize = input.tellg();
-    input.seekg(0, std::ios::beg);
-    auto data = std::vector<T>(fileSize);
-    input.read(reinterpret_cast<char*>(data.data()), fileSize);
+    auto reader = Reader{path};
+    auto data = std::vector<T>(reader.size() / sizeof(T));
+    const auto size = reader.readAt(0, std::as_writable_bytes(std::span{data}));
+    data.resize(size / sizeof(T));
     return data;
 }
 
+size_t readInto(const fs::path& path, std::span<std::byte> data)
+{
+    auto reader = Reader{path};
+    if (reader.size() > data.size()) {
+        throw std::runtime_error{
+            "file does not fit into buffer: " + path.string()};
+    }
+    return reader.readAt(0, data.first(reader.size()));
+}
+
 template <class T>
 void write(const fs::path& path, const T* data, size_t size)
 {
@@ -1,5 +1,10 @@
 #pragma once
 
+#include <fi/archive.hpp>
 #include <fi/build-info.hpp>
 #include <fi/fs.hpp>
 #include <fi/memory_mapped_file.hpp>
+#include <fi/read_many.hpp>
+#include <fi/reader.hpp>
+#include <fi/writable_mapped_file.hpp>
+#include <fi/writer.hpp>
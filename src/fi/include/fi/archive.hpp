@@ -0,0 +1,115 @@
+#pragma once
+
+#include <fi/memory_mapped_file.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fi {
+
+namespace internals {
+
+// Layout of an archive file. Numbers are little-endian.
+//
+//   ArchiveHeader
+//   ArchiveEntry[entryCount], sorted by name
+//   uint32_t[bucketCount], hash table of entry index + 1, 0 when empty
+//   names, not terminated
+//   data of each entry, aligned
+
+inline constexpr std::array<char, 8> archiveMagic {
+    'g', 'e', 'a', 'r', 'c', 'h', 'i', 'v'};
+inline constexpr uint32_t archiveVersion = 1;
+
+struct ArchiveHeader {
+    std::array<char, 8> magic = archiveMagic;
+    uint32_t version = archiveVersion;
+    uint32_t entryCount = 0;
+    uint32_t bucketCount = 0;
+    uint32_t alignment = 0;
+    uint64_t namesOffset = 0;
+    uint64_t namesSize = 0;
+};
+
+struct ArchiveEntry {
+    uint64_t hash = 0;
+    uint64_t offset = 0;
+    uint64_t size = 0;
+    uint32_t nameOffset = 0;
+    uint32_t nameSize = 0;
+};
+
+// FNV-1a, which is stable across platforms and runs
+uint64_t archiveHash(std::string_view name);
+
+} // namespace internals
+
+/**
+ * Read-only pack of named files, mapped into memory. Entries are found by
+ * name through a hash table in the file, in constant time, and their data is
+ * returned as a view into the mapping, without copying. Views stay valid as
+ * long as the archive.
+ */
+class Archive {
+public:
+    struct Entry {
+        std::string_view name;
+        std::span<const std::byte> data;
+    };
+
+    Archive() = default;
+    explicit Archive(const std::filesystem::path& path);
+
+    [[nodiscard]] size_t size() const;
+    [[nodiscard]] bool empty() const;
+
+    /** Entry by index, in order of name. */
+    [[nodiscard]] Entry entry(size_t index) const;
+
+    [[nodiscard]] bool contains(std::string_view name) const;
+    [[nodiscard]] std::optional<std::span<const std::byte>> find(
+        std::string_view name) const;
+
+    /** Data of the named entry; throws std::out_of_range if there is none. */
+    [[nodiscard]] std::span<const std::byte> at(std::string_view name) const;
+
+private:
+    [[nodiscard]] internals::ArchiveEntry record(size_t index) const;
+    [[nodiscard]] std::string_view name(
+        const internals::ArchiveEntry& record) const;
+
+    MemoryMappedFile _file;
+    internals::ArchiveHeader _header;
+    size_t _bucketsOffset = 0;
+};
+
+/** Collects files and writes them as an Archive. */
+class ArchiveBuilder {
+public:
+    static constexpr size_t defaultAlignment = 64;
+
+    void add(std::string name, std::filesystem::path path);
+    void add(std::string name, std::vector<std::byte> data);
+
+    void write(
+        const std::filesystem::path& path,
+        size_t alignment = defaultAlignment) const;
+
+private:
+    struct Source {
+        std::string name;
+        std::filesystem::path path;
+        std::vector<std::byte> data;
+    };
+
+    std::vector<Source> _sources;
+};
+
+} // namespace fi
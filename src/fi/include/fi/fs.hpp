@@ -4,6 +4,8 @@
 #include <filesystem>
 #include <iterator>
 #include <span>
+#include <stdexcept>
+#include <type_traits>
 #include <vector>
 
 namespace fi {
@@ -14,6 +16,26 @@ std::filesystem::path globalConfigPath();
 template <class T>
 std::vector<T> read(const std::filesystem::path& path);
 
+/**
+ * Read a whole file into caller-owned memory, which must be large enough to
+ * hold it. Returns the number of bytes read.
+ */
+size_t readInto(
+    const std::filesystem::path& path, std::span<std::byte> data);
+
+/** Same as above, returning the number of elements read. */
+template <class T>
+requires std::is_trivially_copyable_v<T>
+size_t readInto(const std::filesystem::path& path, std::span<T> data)
+{
+    const auto size = readInto(path, std::as_writable_bytes(data));
+    if (size % sizeof(T) != 0) {
+        throw std::runtime_error{
+            "file size is not a multiple of element size: " + path.string()};
+    }
+    return size / sizeof(T);
+}
+
 template <class T>
 void write(const std::filesystem::path& path, const T* data, size_t size);
 
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <filesystem>
+#include <limits>
 #include <span>
 
 #ifdef _WIN32
@@ -10,10 +12,41 @@
 
 namespace fi {
 
+/** How a mapping is going to be read, as a hint to the kernel. */
+enum class AccessPattern : uint8_t {
+    Normal,
+    Sequential,
+    Random,
+};
+
+/**
+ * Part of the file to map, and hints for reading it. Hints are best effort,
+ * and are ignored where the system does not support them.
+ */
+struct MapOptions {
+    static constexpr size_t toEnd = std::numeric_limits<size_t>::max();
+
+    // Range of the file; need not be aligned to pages
+    uint64_t offset = 0;
+    size_t length = toEnd;
+
+    AccessPattern pattern = AccessPattern::Normal;
+
+    // Start reading the range in the background right away
+    bool willNeed = false;
+
+    // Back the mapping with huge pages, where the file system supports it
+    bool hugePages = false;
+
+    // Read the whole range before the constructor returns (MAP_POPULATE)
+    bool populate = false;
+};
+
 class MemoryMappedFile {
 public:
     MemoryMappedFile() = default;
-    explicit MemoryMappedFile(const std::filesystem::path& path);
+    explicit MemoryMappedFile(
+        const std::filesystem::path& path, const MapOptions& options = {});
     MemoryMappedFile(const MemoryMappedFile& other) = delete;
     MemoryMappedFile(MemoryMappedFile&& other) noexcept;
     ~MemoryMappedFile();
@@ -21,8 +54,20 @@ public:
     MemoryMappedFile& operator=(const MemoryMappedFile& other) = delete;
     MemoryMappedFile& operator=(MemoryMappedFile&& other) noexcept;
 
+    /** Mapped range of the file. */
     [[nodiscard]] std::span<const std::byte> span() const;
 
+    /** Offset of the mapped range in the file. */
+    [[nodiscard]] uint64_t offset() const;
+
+    void advise(AccessPattern pattern) const;
+
+    /**
+     * Ask the kernel to start reading part of the mapped range, given
+     * relative to span(), without waiting for it.
+     */
+    void prefetch(size_t offset = 0, size_t length = MapOptions::toEnd) const;
+
     void clear() noexcept;
 
 private:
@@ -32,7 +77,11 @@ private:
     HANDLE _fileHandle = INVALID_HANDLE_VALUE;
     HANDLE _fileMappingHandle = INVALID_HANDLE_VALUE;
 #endif
+    // Mapped pages, and the requested range within them
+    std::byte* _mapping = nullptr;
+    size_t _mappingSize = 0;
     std::span<std::byte> _span;
+    uint64_t _offset = 0;
 };
 
 } // namespace fi
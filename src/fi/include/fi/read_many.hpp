@@ -0,0 +1,46 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace fi {
+
+/** What a readMany() call read, and how long it took. */
+struct ReadManyStats {
+    [[nodiscard]] double bytesPerSecond() const;
+
+    size_t files = 0;
+    uint64_t bytes = 0;
+    std::chrono::nanoseconds elapsed {};
+};
+
+using ReadCallback =
+    std::function<void(size_t index, std::vector<std::byte> data)>;
+
+inline constexpr size_t defaultReadThreadCount = 8;
+
+/**
+ * Read files concurrently on a few threads, so that loading many small files
+ * is bound by the bandwidth of the disk rather than by the latency of each
+ * read. The callback runs on the calling thread, for each file as it
+ * completes, with the index of its path.
+ *
+ * If a read or the callback fails, the remaining reads are abandoned, and the
+ * exception is rethrown once the threads have stopped.
+ */
+ReadManyStats readMany(
+    std::span<const std::filesystem::path> paths,
+    const ReadCallback& onRead,
+    size_t threadCount = defaultReadThreadCount);
+
+/** Same as above, returning the contents of the files in order of paths. */
+std::vector<std::vector<std::byte>> readMany(
+    std::span<const std::filesystem::path> paths,
+    size_t threadCount = defaultReadThreadCount);
+
+} // namespace fi
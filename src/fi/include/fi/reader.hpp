@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+namespace fi {
+
+/**
+ * Binary file reader that goes through the file in chunks of a fixed-size
+ * buffer, so files of any size are read without allocating for all of them.
+ * The buffer stays with the reader when it opens another file, so loading
+ * many files reuses one allocation.
+ *
+ * With direct I/O, reads bypass the page cache, which helps with large files
+ * that are read once. Where the file system does not support it, the reader
+ * quietly reads through the cache instead.
+ */
+class Reader {
+public:
+    static constexpr size_t defaultBufferSize = 64 * 1024;
+
+    // Alignment of buffers, offsets and sizes for direct I/O, which covers
+    // the logical block size of common devices
+    static constexpr size_t directAlignment = 4096;
+
+    enum class Mode : uint8_t {
+        Buffered,
+        Direct,
+    };
+
+    Reader() = default;
+    explicit Reader(
+        const std::filesystem::path& path,
+        Mode mode = Mode::Buffered,
+        size_t bufferSize = defaultBufferSize);
+    Reader(const Reader& other) = delete;
+    Reader(Reader&& other) noexcept;
+    ~Reader();
+
+    Reader& operator=(const Reader& other) = delete;
+    Reader& operator=(Reader&& other) noexcept;
+
+    /** Close the current file, if any, and start reading another one. */
+    void open(const std::filesystem::path& path, Mode mode = Mode::Buffered);
+    void close() noexcept;
+
+    [[nodiscard]] bool isOpen() const;
+
+    /** Whether reads bypass the page cache. */
+    [[nodiscard]] bool isDirect() const;
+
+    /** Size of the file when it was opened. */
+    [[nodiscard]] uint64_t size() const;
+
+    /** Offset of the next chunk. */
+    [[nodiscard]] uint64_t position() const;
+    void seek(uint64_t position);
+
+    /**
+     * Next chunk of the file, at most the size of the buffer. The chunk is
+     * valid until the next call. Returns an empty span at the end of the file.
+     */
+    std::span<const std::byte> next();
+
+    /**
+     * Read into caller-owned memory at the given offset, without moving the
+     * position or using the buffer. Returns the number of bytes read, which
+     * is less than data.size() only at the end of the file. With direct I/O,
+     * the offset, size and address of data must be aligned to
+     * directAlignment.
+     */
+    size_t readAt(uint64_t offset, std::span<std::byte> data) const;
+
+private:
+    struct AlignedDelete {
+        void operator()(std::byte* buffer) const;
+    };
+
+#ifdef __linux__
+    int _fd = -1;
+#elif defined(_WIN32)
+    HANDLE _fileHandle = INVALID_HANDLE_VALUE;
+#endif
+    std::filesystem::path _path;
+    bool _direct = false;
+    uint64_t _size = 0;
+    uint64_t _position = 0;
+
+    // Allocated on the first call to next()
+    std::unique_ptr<std::byte[], AlignedDelete> _buffer;
+    size_t _bufferSize = defaultBufferSize;
+};
+
+} // namespace fi
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <span>
+#include <type_traits>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+namespace fi {
+
+/**
+ * File written through a shared, writable memory mapping. The mapping grows
+ * with the data: the file is extended, geometrically, and mapped again, so
+ * appending takes amortized constant time and writes go straight to the page
+ * cache without an intermediate buffer. Growing invalidates spans taken
+ * before.
+ *
+ * The file is extended ahead of the data, and trimmed to size() on close().
+ * If the process dies before that, the file keeps trailing zeros.
+ */
+class WritableMappedFile {
+public:
+    static constexpr size_t toEnd = std::numeric_limits<size_t>::max();
+    static constexpr size_t defaultCapacity = 64 * 1024;
+
+    enum class Mode : uint8_t {
+        // Create the file, or empty it if it exists
+        Truncate,
+
+        // Keep the contents of an existing file, or create it
+        Keep,
+    };
+
+    WritableMappedFile() = default;
+    explicit WritableMappedFile(
+        const std::filesystem::path& path,
+        Mode mode = Mode::Truncate,
+        size_t capacity = defaultCapacity);
+    WritableMappedFile(const WritableMappedFile& other) = delete;
+    WritableMappedFile(WritableMappedFile&& other) noexcept;
+    ~WritableMappedFile();
+
+    WritableMappedFile& operator=(const WritableMappedFile& other) = delete;
+    WritableMappedFile& operator=(WritableMappedFile&& other) noexcept;
+
+    [[nodiscard]] bool isOpen() const;
+
+    /** Data written so far. */
+    [[nodiscard]] std::span<std::byte> span();
+    [[nodiscard]] std::span<const std::byte> span() const;
+
+    [[nodiscard]] size_t size() const;
+    [[nodiscard]] size_t capacity() const;
+
+    /** Extend the file and the mapping to hold at least capacity bytes. */
+    void reserve(size_t capacity);
+
+    /** Set the size of the data; new bytes are zero. */
+    void resize(size_t size);
+
+    /** Append size bytes, and return them to be filled in place. */
+    std::span<std::byte> extend(size_t size);
+
+    void write(std::span<const std::byte> data);
+
+    template <class T>
+    requires std::is_trivially_copyable_v<T>
+    void write(const T& value)
+    {
+        write(std::span<const std::byte>{
+            reinterpret_cast<const std::byte*>(&value), sizeof(T)});
+    }
+
+    /**
+     * Write a range of the data back to the file. Without waiting, the
+     * write-back is only scheduled.
+     */
+    void flush(size_t offset = 0, size_t length = toEnd, bool wait = true);
+
+    /** Unmap the file, and trim it to size(). */
+    void close();
+
+private:
+    void map(size_t capacity);
+    void unmap() noexcept;
+
+#ifdef __linux__
+    int _fd = -1;
+#elif defined(_WIN32)
+    HANDLE _fileHandle = INVALID_HANDLE_VALUE;
+    HANDLE _fileMappingHandle = INVALID_HANDLE_VALUE;
+#endif
+    std::filesystem::path _path;
+    std::byte* _mapping = nullptr;
+    size_t _capacity = 0;
+    size_t _size = 0;
+
+    // End of the bytes that may have been written; the rest is still zero
+    size_t _highWater = 0;
+};
+
+} // namespace fi
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace fi {
+
+/**
+ * Sequential binary file writer that collects small writes into a buffer and
+ * passes them to the file system in large blocks.
+ */
+class Writer {
+public:
+    static constexpr size_t defaultBufferSize = 64 * 1024;
+
+    explicit Writer(
+        const std::filesystem::path& path,
+        size_t bufferSize = defaultBufferSize);
+    Writer(const Writer& other) = delete;
+    Writer(Writer&& other) noexcept = default;
+    ~Writer();
+
+    Writer& operator=(const Writer& other) = delete;
+    Writer& operator=(Writer&& other) noexcept = default;
+
+    void write(std::span<const std::byte> data);
+
+    template <class T>
+    requires std::is_trivially_copyable_v<T>
+    void write(const T& value)
+    {
+        write(std::span<const std::byte>{
+            reinterpret_cast<const std::byte*>(&value), sizeof(T)});
+    }
+
+    void flush();
+
+private:
+    std::ofstream _output;
+    std::vector<std::byte> _buffer;
+};
+
+} // namespace fi
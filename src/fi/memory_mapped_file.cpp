@@ -1,8 +1,11 @@
 #include <fi/memory_mapped_file.hpp>
 
+#include <algorithm>
 #include <stdexcept>
+#include <string>
+#include <utility>
 
-#ifdef __linux
+#ifdef __linux__
 #include <fcntl.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
@@ -13,36 +16,52 @@ namespace fs = std::filesystem;
 
 namespace fi {
 
-MemoryMappedFile::MemoryMappedFile(const fs::path& path)
+namespace {
+
+size_t mappingGranularity()
+{
+#ifdef __linux__
+    static const auto pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return pageSize;
+#elif defined(_WIN32)
+    static const auto granularity = [] {
+        SYSTEM_INFO info{};
+        GetSystemInfo(&info);
+        return static_cast<size_t>(info.dwAllocationGranularity);
+    }();
+    return granularity;
+#endif
+}
+
+} // namespace
+
+MemoryMappedFile::MemoryMappedFile(
+    const fs::path& path, const MapOptions& options)
 {
     if (!fs::exists(path)) {
         throw std::runtime_error{"MemoryMappedFile: path does not exist: " + path.string()};
     }
 
+    auto fail = [this, &path] (const std::string& message) {
+        clear();
+        return std::runtime_error{
+            "MemoryMappedFile: " + message + ": " + path.string()};
+    };
+
 #ifdef __linux__
-    _fd = open(path.string().c_str(), O_RDONLY); // NOLINT
+    _fd = open(path.string().c_str(), O_RDONLY | O_CLOEXEC); // NOLINT
     if (_fd == -1) {
-        throw std::runtime_error{
-            "MemoryMappedFile: failed to open file: " + path.string()};
+        throw fail("failed to open file");
     }
 
-    size_t fileSize = 0;
+    uint64_t fileSize = 0;
     {
         struct stat sb{};
         if (fstat(_fd, &sb) == -1) {
-            throw std::runtime_error{
-                "MemoryMappedFile: failed to fstat file: " + path.string()};
+            throw fail("failed to fstat file");
         }
-        fileSize = sb.st_size;
-    }
-
-    void* address = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, _fd, 0);
-    if (address == MAP_FAILED) {
-        throw std::runtime_error{
-            "MemoryMappedFile: failed to mmap file: " + path.string()};
+        fileSize = static_cast<uint64_t>(sb.st_size);
     }
-
-    _span = {static_cast<std::byte*>(address), static_cast<size_t>(fileSize)};
 #elif defined(_WIN32)
     _fileHandle = CreateFile(
         path.string().c_str(),
@@ -53,42 +72,93 @@ MemoryMappedFile::MemoryMappedFile(const fs::path& path)
         FILE_ATTRIBUTE_NORMAL,
         nullptr);
     if (_fileHandle == INVALID_HANDLE_VALUE) {
-        throw std::runtime_error{"CreateFile failed: " + GetLastError()};
+        throw fail("CreateFile failed: " + std::to_string(GetLastError()));
     }
 
-    LARGE_INTEGER fileSize{};
-    if (!GetFileSizeEx(_fileHandle, &fileSize)) {
-        throw std::runtime_error{"GetFileSizeEx failed: " + GetLastError()};
+    LARGE_INTEGER size{};
+    if (!GetFileSizeEx(_fileHandle, &size)) {
+        throw fail("GetFileSizeEx failed: " + std::to_string(GetLastError()));
     }
+    auto fileSize = static_cast<uint64_t>(size.QuadPart);
+#endif
 
+    if (options.offset > fileSize) {
+        throw fail("offset is past the end of file");
+    }
+    auto length = static_cast<size_t>(
+        std::min<uint64_t>(options.length, fileSize - options.offset));
+    _offset = options.offset;
+    if (length == 0) {
+        // Nothing to map; empty mappings are not allowed
+        return;
+    }
+
+    // Mappings start at a page, or allocation granularity, boundary
+    auto alignedOffset =
+        options.offset - options.offset % mappingGranularity();
+    auto lead = static_cast<size_t>(options.offset - alignedOffset);
+    _mappingSize = lead + length;
+
+#ifdef __linux__
+    int flags = MAP_PRIVATE;
+    if (options.populate) {
+        flags |= MAP_POPULATE;
+    }
+    void* address = mmap(
+        nullptr, _mappingSize, PROT_READ, flags, _fd,
+        static_cast<off_t>(alignedOffset));
+    if (address == MAP_FAILED) {
+        _mappingSize = 0;
+        throw fail("failed to mmap file");
+    }
+#elif defined(_WIN32)
     _fileMappingHandle =
         CreateFileMapping(_fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
     if (_fileMappingHandle == NULL) {
-        throw std::runtime_error{"CreateFileMapping failed: " + GetLastError()};
+        _fileMappingHandle = INVALID_HANDLE_VALUE;
+        throw fail(
+            "CreateFileMapping failed: " + std::to_string(GetLastError()));
     }
 
-    LPVOID address = MapViewOfFile(_fileMappingHandle, FILE_MAP_READ, 0, 0, 0);
+    LPVOID address = MapViewOfFile(
+        _fileMappingHandle,
+        FILE_MAP_READ,
+        static_cast<DWORD>(alignedOffset >> 32),
+        static_cast<DWORD>(alignedOffset & 0xFFFFFFFF),
+        _mappingSize);
     if (!address) {
-        throw std::runtime_error{"MapViewOfFile failed: " + GetLastError()};
+        _mappingSize = 0;
+        throw fail("MapViewOfFile failed: " + std::to_string(GetLastError()));
     }
+#endif
 
-    _span = {
-        static_cast<std::byte*>(address),
-        static_cast<size_t>(fileSize.QuadPart)
-    };
+    _mapping = static_cast<std::byte*>(address);
+    _span = {_mapping + lead, length};
+
+    advise(options.pattern);
+#ifdef __linux__
+    if (options.hugePages) {
+        madvise(_mapping, _mappingSize, MADV_HUGEPAGE);
+    }
 #endif
+    if (options.willNeed && !options.populate) {
+        prefetch();
+    }
 }
 
 MemoryMappedFile::MemoryMappedFile(MemoryMappedFile&& other) noexcept
-#ifdef linux
-    : _fd(other._fd)
+#ifdef __linux__
+    : _fd(std::exchange(other._fd, -1))
 #elif defined(_WIN32)
-    : _fileHandle(other._fileHandle)
-    , _fileMappingHandle(other._fileMappingHandle)
+    : _fileHandle(std::exchange(other._fileHandle, INVALID_HANDLE_VALUE))
+    , _fileMappingHandle(
+        std::exchange(other._fileMappingHandle, INVALID_HANDLE_VALUE))
 #endif
-{
-    std::swap(_span, other._span);
-}
+    , _mapping(std::exchange(other._mapping, nullptr))
+    , _mappingSize(std::exchange(other._mappingSize, 0))
+    , _span(std::exchange(other._span, {}))
+    , _offset(std::exchange(other._offset, 0))
+{ }
 
 MemoryMappedFile::~MemoryMappedFile()
 {
@@ -97,17 +167,20 @@ MemoryMappedFile::~MemoryMappedFile()
 
 MemoryMappedFile& MemoryMappedFile::operator=(MemoryMappedFile&& other) noexcept
 {
-    clear();
+    if (this != &other) {
+        clear();
 
-#ifdef linux
-    std::swap(_fd, other._fd);
+#ifdef __linux__
+        std::swap(_fd, other._fd);
 #elif defined(_WIN32)
-    std::swap(_fileHandle, other._fileHandle);
-    std::swap(_fileMappingHandle, other._fileMappingHandle);
+        std::swap(_fileHandle, other._fileHandle);
+        std::swap(_fileMappingHandle, other._fileMappingHandle);
 #endif
-
-    std::swap(_span, other._span);
-
+        std::swap(_mapping, other._mapping);
+        std::swap(_mappingSize, other._mappingSize);
+        std::swap(_span, other._span);
+        std::swap(_offset, other._offset);
+    }
     return *this;
 }
 
@@ -116,21 +189,78 @@ std::span<const std::byte> MemoryMappedFile::span() const
     return _span;
 }
 
+uint64_t MemoryMappedFile::offset() const
+{
+    return _offset;
+}
+
+void MemoryMappedFile::advise(AccessPattern pattern) const
+{
+#ifdef __linux__
+    if (_mapping) {
+        int advice = MADV_NORMAL;
+        switch (pattern) {
+            case AccessPattern::Normal: advice = MADV_NORMAL; break;
+            case AccessPattern::Sequential: advice = MADV_SEQUENTIAL; break;
+            case AccessPattern::Random: advice = MADV_RANDOM; break;
+        }
+        madvise(_mapping, _mappingSize, advice);
+    }
+#else
+    (void)pattern;
+#endif
+}
+
+void MemoryMappedFile::prefetch(size_t offset, size_t length) const
+{
+    if (offset >= _span.size()) {
+        return;
+    }
+    length = std::min(length, _span.size() - offset);
+
+    // Extend the range to whole pages within the mapping
+    auto begin = static_cast<size_t>(_span.data() - _mapping) + offset;
+    begin -= begin % mappingGranularity();
+    auto end = static_cast<size_t>(_span.data() - _mapping) + offset + length;
+
+#ifdef __linux__
+    madvise(_mapping + begin, end - begin, MADV_WILLNEED);
+#elif defined(_WIN32)
+    auto range = WIN32_MEMORY_RANGE_ENTRY{
+        .VirtualAddress = _mapping + begin,
+        .NumberOfBytes = end - begin,
+    };
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#endif
+}
+
 void MemoryMappedFile::clear() noexcept
 {
-    if (!_span.empty()) {
-#ifdef linux
-        munmap(_span.data(), _span.size());
+#ifdef __linux__
+    if (_mapping) {
+        munmap(_mapping, _mappingSize);
+    }
+    if (_fd != -1) {
         close(_fd);
         _fd = -1;
+    }
 #elif defined(_WIN32)
-        UnmapViewOfFile(_span.data());
+    if (_mapping) {
+        UnmapViewOfFile(_mapping);
+    }
+    if (_fileMappingHandle != INVALID_HANDLE_VALUE) {
+        CloseHandle(_fileMappingHandle);
+        _fileMappingHandle = INVALID_HANDLE_VALUE;
+    }
+    if (_fileHandle != INVALID_HANDLE_VALUE) {
         CloseHandle(_fileHandle);
         _fileHandle = INVALID_HANDLE_VALUE;
-        _fileMappingHandle = INVALID_HANDLE_VALUE;
-#endif
-        _span = {};
     }
+#endif
+    _mapping = nullptr;
+    _mappingSize = 0;
+    _span = {};
+    _offset = 0;
 }
 
 } // namespace fi
@@ -0,0 +1,78 @@
+#include <fi.hpp>
+
+#include <arg.hpp>
+
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Entry names are paths relative to the root, with forward slashes on every
+// platform
+void addPath(fi::ArchiveBuilder& builder, const fs::path& root, fs::path path)
+{
+    if (path.is_relative()) {
+        path = root / path;
+    }
+
+    auto addFile = [&] (const fs::path& file) {
+        auto name = fs::relative(file, root).generic_string();
+        if (name.empty() || name.starts_with("..")) {
+            throw std::runtime_error{
+                "fi-pack: file outside of root: " + file.string()};
+        }
+        builder.add(std::move(name), file);
+    };
+
+    if (fs::is_directory(path)) {
+        for (const auto& entry : fs::recursive_directory_iterator{path}) {
+            if (entry.is_regular_file()) {
+                addFile(entry.path());
+            }
+        }
+    } else {
+        addFile(path);
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    arg::helpKeys("-h", "--help");
+    auto outputPath = arg::option<std::string>()
+        .keys("-o", "--output")
+        .metavar("PATH")
+        .markRequired()
+        .help("archive to write");
+    auto rootPath = arg::option<std::string>()
+        .keys("-C", "--root")
+        .metavar("DIR")
+        .defaultValue(".")
+        .help("directory that entry names are relative to");
+    auto inputs = arg::multiOption<std::string>()
+        .keys("-i", "--input")
+        .metavar("PATH")
+        .help("file or directory to pack, relative to the root");
+    auto alignment = arg::option<size_t>()
+        .keys("-a", "--alignment")
+        .defaultValue(size_t{fi::ArchiveBuilder::defaultAlignment})
+        .help("alignment of entry data in the archive");
+    arg::parse(argc, argv);
+
+    try {
+        auto builder = fi::ArchiveBuilder{};
+        for (const auto& input : inputs.vector()) {
+            addPath(builder, *rootPath, input);
+        }
+        builder.write(*outputPath, *alignment);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+}
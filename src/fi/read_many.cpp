@@ -0,0 +1,184 @@
+#include <fi/read_many.hpp>
+
+#include <fi/fs.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace fs = std::filesystem;
+
+namespace fi {
+
+namespace {
+
+struct Completed {
+    size_t index = 0;
+    std::vector<std::byte> data;
+};
+
+// Files completed by the workers and not yet given to the callback
+class Completions {
+public:
+    explicit Completions(size_t workerCount)
+        : _running(workerCount)
+    { }
+
+    void push(Completed completed)
+    {
+        {
+            auto lock = std::scoped_lock{_mutex};
+            _queue.push_back(std::move(completed));
+        }
+        _condition.notify_one();
+    }
+
+    void fail(std::exception_ptr exception)
+    {
+        auto lock = std::scoped_lock{_mutex};
+        if (!_exception) {
+            _exception = std::move(exception);
+        }
+        _stop = true;
+    }
+
+    [[nodiscard]] bool stopped()
+    {
+        auto lock = std::scoped_lock{_mutex};
+        return _stop;
+    }
+
+    void finishWorker()
+    {
+        {
+            auto lock = std::scoped_lock{_mutex};
+            _running--;
+        }
+        _condition.notify_one();
+    }
+
+    // Wait for completed files, and take all there are. Returns false when
+    // the workers are done and nothing is left.
+    bool take(std::vector<Completed>& batch)
+    {
+        batch.clear();
+        auto lock = std::unique_lock{_mutex};
+        _condition.wait(lock, [this] {
+            return !_queue.empty() || _running == 0;
+        });
+        std::swap(batch, _queue);
+        return !batch.empty();
+    }
+
+    [[nodiscard]] std::exception_ptr exception()
+    {
+        auto lock = std::scoped_lock{_mutex};
+        return _exception;
+    }
+
+private:
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    std::vector<Completed> _queue;
+    size_t _running = 0;
+    bool _stop = false;
+    std::exception_ptr _exception;
+};
+
+} // namespace
+
+double ReadManyStats::bytesPerSecond() const
+{
+    const auto seconds = std::chrono::duration<double>(elapsed).count();
+    return seconds > 0 ? static_cast<double>(bytes) / seconds : 0;
+}
+
+ReadManyStats readMany(
+    std::span<const fs::path> paths,
+    const ReadCallback& onRead,
+    size_t threadCount)
+{
+    using Clock = std::chrono::steady_clock;
+
+    const auto start = Clock::now();
+    auto stats = ReadManyStats{.files = paths.size()};
+    auto deliver = [&] (size_t index, std::vector<std::byte> data) {
+        stats.bytes += data.size();
+        onRead(index, std::move(data));
+    };
+
+    const auto workerCount = std::min(threadCount, paths.size());
+    if (workerCount <= 1) {
+        for (size_t i = 0; i < paths.size(); i++) {
+            deliver(i, read<std::byte>(paths[i]));
+        }
+        stats.elapsed = Clock::now() - start;
+        return stats;
+    }
+
+    // Workers take paths in order, so that files come back roughly in the
+    // order they were asked for
+    auto completions = Completions{workerCount};
+    auto next = std::atomic<size_t>{0};
+    auto work = [&] {
+        for (;;) {
+            const auto index = next.fetch_add(1, std::memory_order_relaxed);
+            if (index >= paths.size() || completions.stopped()) {
+                break;
+            }
+            try {
+                completions.push(Completed{
+                    .index = index,
+                    .data = read<std::byte>(paths[index]),
+                });
+            } catch (...) {
+                completions.fail(std::current_exception());
+                break;
+            }
+        }
+        completions.finishWorker();
+    };
+
+    auto workers = std::vector<std::thread>{};
+    workers.reserve(workerCount);
+    for (size_t i = 0; i < workerCount; i++) {
+        workers.emplace_back(work);
+    }
+
+    try {
+        auto batch = std::vector<Completed>{};
+        while (completions.take(batch)) {
+            for (auto& completed : batch) {
+                deliver(completed.index, std::move(completed.data));
+            }
+        }
+    } catch (...) {
+        completions.fail(std::current_exception());
+    }
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    if (auto exception = completions.exception()) {
+        std::rethrow_exception(exception);
+    }
+
+    stats.elapsed = Clock::now() - start;
+    return stats;
+}
+
+std::vector<std::vector<std::byte>> readMany(
+    std::span<const fs::path> paths, size_t threadCount)
+{
+    auto contents = std::vector<std::vector<std::byte>>(paths.size());
+    readMany(paths, [&contents] (size_t index, std::vector<std::byte> data) {
+        contents[index] = std::move(data);
+    }, threadCount);
+    return contents;
+}
+
+} // namespace fi
@@ -0,0 +1,269 @@
+#include <fi/reader.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace fi {
+
+namespace {
+
+constexpr auto bufferAlignment = std::align_val_t{Reader::directAlignment};
+
+size_t roundUp(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+bool isAligned(uint64_t value)
+{
+    return value % Reader::directAlignment == 0;
+}
+
+} // namespace
+
+void Reader::AlignedDelete::operator()(std::byte* buffer) const
+{
+    ::operator delete[](buffer, bufferAlignment);
+}
+
+Reader::Reader(const fs::path& path, Mode mode, size_t bufferSize)
+    : _bufferSize(roundUp(std::max<size_t>(bufferSize, 1), directAlignment))
+{
+    open(path, mode);
+}
+
+Reader::Reader(Reader&& other) noexcept
+#ifdef __linux__
+    : _fd(std::exchange(other._fd, -1))
+#elif defined(_WIN32)
+    : _fileHandle(std::exchange(other._fileHandle, INVALID_HANDLE_VALUE))
+#endif
+    , _path(std::move(other._path))
+    , _direct(std::exchange(other._direct, false))
+    , _size(std::exchange(other._size, 0))
+    , _position(std::exchange(other._position, 0))
+    , _buffer(std::move(other._buffer))
+    , _bufferSize(std::exchange(other._bufferSize, defaultBufferSize))
+{ }
+
+Reader::~Reader()
+{
+    close();
+}
+
+Reader& Reader::operator=(Reader&& other) noexcept
+{
+    if (this != &other) {
+        close();
+#ifdef __linux__
+        _fd = std::exchange(other._fd, -1);
+#elif defined(_WIN32)
+        _fileHandle = std::exchange(other._fileHandle, INVALID_HANDLE_VALUE);
+#endif
+        _path = std::move(other._path);
+        _direct = std::exchange(other._direct, false);
+        _size = std::exchange(other._size, 0);
+        _position = std::exchange(other._position, 0);
+        _buffer = std::move(other._buffer);
+        _bufferSize = std::exchange(other._bufferSize, defaultBufferSize);
+    }
+    return *this;
+}
+
+void Reader::open(const fs::path& path, Mode mode)
+{
+    close();
+    _path = path;
+
+#ifdef __linux__
+    const int flags = O_RDONLY | O_CLOEXEC;
+    if (mode == Mode::Direct) {
+        _fd = ::open(path.c_str(), flags | O_DIRECT); // NOLINT
+        _direct = _fd != -1;
+    }
+    if (_fd == -1) {
+        _fd = ::open(path.c_str(), flags); // NOLINT
+    }
+    if (_fd == -1) {
+        throw std::runtime_error{
+            "Reader: failed to open file: " + path.string() + ": " +
+            std::strerror(errno)};
+    }
+
+    struct stat sb{};
+    if (fstat(_fd, &sb) == -1) {
+        close();
+        throw std::runtime_error{
+            "Reader: failed to fstat file: " + path.string()};
+    }
+    _size = static_cast<uint64_t>(sb.st_size);
+
+    if (!_direct) {
+        posix_fadvise(_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    }
+#elif defined(_WIN32)
+    const DWORD flags = FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN;
+    auto openFile = [&path] (DWORD flags) {
+        return CreateFileW(
+            path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+            OPEN_EXISTING, flags, nullptr);
+    };
+    if (mode == Mode::Direct) {
+        _fileHandle = openFile(flags | FILE_FLAG_NO_BUFFERING);
+        _direct = _fileHandle != INVALID_HANDLE_VALUE;
+    }
+    if (_fileHandle == INVALID_HANDLE_VALUE) {
+        _fileHandle = openFile(flags);
+    }
+    if (_fileHandle == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error{
+            "Reader: CreateFile failed: " + std::to_string(GetLastError()) +
+            ": " + path.string()};
+    }
+
+    auto size = LARGE_INTEGER{};
+    if (!GetFileSizeEx(_fileHandle, &size)) {
+        close();
+        throw std::runtime_error{
+            "Reader: GetFileSizeEx failed: " +
+            std::to_string(GetLastError()) + ": " + path.string()};
+    }
+    _size = static_cast<uint64_t>(size.QuadPart);
+#endif
+}
+
+void Reader::close() noexcept
+{
+#ifdef __linux__
+    if (_fd != -1) {
+        ::close(_fd);
+        _fd = -1;
+    }
+#elif defined(_WIN32)
+    if (_fileHandle != INVALID_HANDLE_VALUE) {
+        CloseHandle(_fileHandle);
+        _fileHandle = INVALID_HANDLE_VALUE;
+    }
+#endif
+    _direct = false;
+    _size = 0;
+    _position = 0;
+}
+
+bool Reader::isOpen() const
+{
+#ifdef __linux__
+    return _fd != -1;
+#elif defined(_WIN32)
+    return _fileHandle != INVALID_HANDLE_VALUE;
+#endif
+}
+
+bool Reader::isDirect() const
+{
+    return _direct;
+}
+
+uint64_t Reader::size() const
+{
+    return _size;
+}
+
+uint64_t Reader::position() const
+{
+    return _position;
+}
+
+void Reader::seek(uint64_t position)
+{
+    _position = position;
+}
+
+std::span<const std::byte> Reader::next()
+{
+    if (!_buffer) {
+        _buffer.reset(static_cast<std::byte*>(
+            ::operator new[](_bufferSize, bufferAlignment)));
+    }
+
+    // Direct reads start at an aligned offset, and the chunk skips the bytes
+    // before the position
+    const auto start = _direct ?
+        _position / directAlignment * directAlignment : _position;
+    const auto skip = static_cast<size_t>(_position - start);
+    const auto count = readAt(start, {_buffer.get(), _bufferSize});
+    if (count <= skip) {
+        return {};
+    }
+
+    _position += count - skip;
+    return {_buffer.get() + skip, count - skip};
+}
+
+size_t Reader::readAt(uint64_t offset, std::span<std::byte> data) const
+{
+    if (!isOpen()) {
+        throw std::logic_error{"Reader: no file is open"};
+    }
+    if (_direct && !(isAligned(offset) && isAligned(data.size()) &&
+            isAligned(reinterpret_cast<uintptr_t>(data.data())))) {
+        throw std::invalid_argument{
+            "Reader: unaligned direct read: " + _path.string()};
+    }
+
+    size_t count = 0;
+    while (count < data.size()) {
+#ifdef __linux__
+        const auto result = pread(
+            _fd, data.data() + count, data.size() - count,
+            static_cast<off_t>(offset + count));
+        if (result == -1 && errno == EINTR) {
+            continue;
+        }
+        if (result == -1) {
+            throw std::runtime_error{
+                "Reader: failed to read file: " + _path.string() + ": " +
+                std::strerror(errno)};
+        }
+        const auto read = static_cast<size_t>(result);
+#elif defined(_WIN32)
+        const auto position = offset + count;
+        auto overlapped = OVERLAPPED{};
+        overlapped.Offset = static_cast<DWORD>(position);
+        overlapped.OffsetHigh = static_cast<DWORD>(position >> 32);
+        DWORD read = 0;
+        const auto request = static_cast<DWORD>(
+            std::min<size_t>(data.size() - count, 1U << 30U));
+        if (!ReadFile(_fileHandle, data.data() + count, request, &read,
+                &overlapped) && GetLastError() != ERROR_HANDLE_EOF) {
+            throw std::runtime_error{
+                "Reader: ReadFile failed: " + std::to_string(GetLastError()) +
+                ": " + _path.string()};
+        }
+#endif
+        count += read;
+
+        // A short direct read means the end of the file, and reading on from
+        // the unaligned offset would fail
+        if (read == 0 || (_direct && !isAligned(count))) {
+            break;
+        }
+    }
+    return count;
+}
+
+} // namespace fi
@@ -0,0 +1,143 @@
+#include "temp_directory.hpp"
+#include "test_data.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <fi/archive.hpp>
+#include <fi/fs.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+TEST_CASE("Archive entries are found by name", "[archive]")
+{
+    const auto directory = TempDirectory{};
+    writeBytes(directory / "file.bin", makeData(1000, 7));
+
+    auto builder = fi::ArchiveBuilder{};
+    for (size_t i = 0; i < 100; i++) {
+        builder.add("entry-" + std::to_string(i), makeData(i * 13, i));
+    }
+    builder.add("dir/file.bin", directory / "file.bin");
+    builder.add("empty", std::vector<std::byte>{});
+    builder.write(directory / "test.pack", 32);
+
+    const auto archive = fi::Archive{directory / "test.pack"};
+    REQUIRE(archive.size() == 102);
+
+    for (size_t i = 0; i < 100; i++) {
+        const auto name = "entry-" + std::to_string(i);
+        REQUIRE(archive.contains(name));
+        auto data = archive.at(name);
+        REQUIRE(equal(data, makeData(i * 13, i)));
+        REQUIRE(reinterpret_cast<uintptr_t>(data.data()) % 32 == 0);
+    }
+    REQUIRE(equal(archive.at("dir/file.bin"), makeData(1000, 7)));
+    REQUIRE(archive.find("empty").has_value());
+    REQUIRE(archive.find("empty")->empty());
+
+    REQUIRE(!archive.contains("entry-100"));
+    REQUIRE(!archive.find("dir").has_value());
+    REQUIRE_THROWS_AS(archive.at("missing"), std::out_of_range);
+}
+
+TEST_CASE("Archive entries are listed in order of name", "[archive]")
+{
+    const auto directory = TempDirectory{};
+    auto builder = fi::ArchiveBuilder{};
+    builder.add("b", makeData(3, 2));
+    builder.add("c", makeData(4, 3));
+    builder.add("a", makeData(2, 1));
+    builder.write(directory / "test.pack");
+
+    const auto archive = fi::Archive{directory / "test.pack"};
+    REQUIRE(archive.size() == 3);
+    REQUIRE(archive.entry(0).name == "a");
+    REQUIRE(archive.entry(1).name == "b");
+    REQUIRE(archive.entry(2).name == "c");
+    REQUIRE(equal(archive.entry(2).data, makeData(4, 3)));
+    REQUIRE_THROWS_AS(archive.entry(3), std::out_of_range);
+}
+
+TEST_CASE("Empty archive", "[archive]")
+{
+    const auto directory = TempDirectory{};
+    fi::ArchiveBuilder{}.write(directory / "empty.pack");
+
+    const auto archive = fi::Archive{directory / "empty.pack"};
+    REQUIRE(archive.empty());
+    REQUIRE(archive.size() == 0);
+    REQUIRE(!archive.contains(""));
+    REQUIRE(!archive.find("anything").has_value());
+}
+
+TEST_CASE("Archive builder rejects bad input", "[archive]")
+{
+    const auto directory = TempDirectory{};
+
+    auto duplicate = fi::ArchiveBuilder{};
+    duplicate.add("same", makeData(1, 1));
+    duplicate.add("other", makeData(1, 2));
+    duplicate.add("same", makeData(1, 3));
+    REQUIRE_THROWS_AS(
+        duplicate.write(directory / "test.pack"), std::invalid_argument);
+
+    auto builder = fi::ArchiveBuilder{};
+    builder.add("entry", makeData(1, 1));
+    REQUIRE_THROWS_AS(
+        builder.write(directory / "test.pack", 3), std::invalid_argument);
+}
+
+TEST_CASE("Corrupt archives are rejected on open", "[archive]")
+{
+    const auto directory = TempDirectory{};
+    auto builder = fi::ArchiveBuilder{};
+    builder.add("first", makeData(100, 1));
+    builder.add("second", makeData(200, 2));
+    builder.write(directory / "good.pack");
+
+    const auto good = fi::read<std::byte>(directory / "good.pack");
+    auto check = [&] (std::vector<std::byte> bytes) {
+        writeBytes(directory / "bad.pack", bytes);
+        REQUIRE_THROWS_AS(
+            fi::Archive{directory / "bad.pack"}, std::runtime_error);
+    };
+
+    SECTION("Empty file") {
+        check({});
+    }
+    SECTION("Truncated header") {
+        check({good.begin(), good.begin() + 20});
+    }
+    SECTION("Truncated tables") {
+        check({good.begin(), good.begin() + 60});
+    }
+    SECTION("Truncated data") {
+        check({good.begin(), good.end() - 1});
+    }
+    SECTION("Bad magic") {
+        auto bytes = good;
+        bytes[0] = std::byte{'x'};
+        check(bytes);
+    }
+    SECTION("Unknown version") {
+        auto bytes = good;
+        bytes[8] = std::byte{99};
+        check(bytes);
+    }
+    SECTION("Bucket count not a power of two") {
+        auto bytes = good;
+        bytes[16] = std::byte{3};
+        check(bytes);
+    }
+    SECTION("Entry out of bounds") {
+        // Offset of the first entry, after its 8-byte hash
+        auto bytes = good;
+        bytes[40 + 8 + 7] = std::byte{0x7f};
+        check(bytes);
+    }
+}
@@ -0,0 +1,162 @@
+#include "temp_directory.hpp"
+#include "test_data.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <fi/memory_mapped_file.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+namespace {
+
+std::span<const std::byte> expected(
+    const std::vector<std::byte>& data, size_t offset, size_t length)
+{
+    return std::span{data}.subspan(
+        offset, std::min(length, data.size() - offset));
+}
+
+} // namespace
+
+TEST_CASE("Mapped ranges need not be page aligned", "[memory-mapped-file]")
+{
+    const auto directory = TempDirectory{};
+    const auto data = makeData(3 * 65'536 + 123, 6);
+    writeBytes(directory / "file", data);
+
+    const auto offsets = std::vector<size_t>{
+        0, 1, 511, 4095, 4096, 4097, 16'385, 65'535, 65'537, 150'000,
+        data.size() - 1};
+    const auto lengths = std::vector<size_t>{
+        1, 2, 100, 4095, 4096, 4097, 70'000, fi::MapOptions::toEnd};
+
+    size_t hints = 0;
+    for (auto offset : offsets) {
+        for (auto length : lengths) {
+            // Cycle through the hints, which must not change what is read
+            auto options = fi::MapOptions{.offset = offset, .length = length};
+            options.pattern = static_cast<fi::AccessPattern>(hints % 3);
+            options.willNeed = hints % 2 == 0;
+            options.populate = hints % 5 == 0;
+            options.hugePages = hints % 7 == 0;
+            hints++;
+
+            const auto file = fi::MemoryMappedFile{directory / "file", options};
+            REQUIRE(file.offset() == offset);
+            REQUIRE(equal(file.span(), expected(data, offset, length)));
+        }
+    }
+}
+
+TEST_CASE("Mapped ranges start within their page", "[memory-mapped-file]")
+{
+#ifdef __linux__
+    const auto pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const auto directory = TempDirectory{};
+    const auto data = makeData(3 * pageSize, 8);
+    writeBytes(directory / "file", data);
+
+    for (auto offset : {size_t{1}, pageSize - 1, pageSize, pageSize + 7}) {
+        const auto file = fi::MemoryMappedFile{
+            directory / "file", {.offset = offset, .length = pageSize}};
+        const auto address = reinterpret_cast<uintptr_t>(file.span().data());
+        REQUIRE(address % pageSize == offset % pageSize);
+        REQUIRE(file.span().size() == pageSize);
+        REQUIRE(equal(file.span(), expected(data, offset, pageSize)));
+    }
+#endif
+}
+
+TEST_CASE("Empty mapped ranges", "[memory-mapped-file]")
+{
+    const auto directory = TempDirectory{};
+    const auto data = makeData(5000, 2);
+    writeBytes(directory / "file", data);
+    writeBytes(directory / "empty", {});
+
+    for (auto offset : {size_t{0}, size_t{4096}, data.size()}) {
+        const auto file = fi::MemoryMappedFile{
+            directory / "file", {.offset = offset, .length = 0}};
+        REQUIRE(file.span().empty());
+        REQUIRE(file.offset() == offset);
+        REQUIRE_NOTHROW(file.prefetch());
+    }
+
+    // At the end of the file, any length is empty
+    const auto end = fi::MemoryMappedFile{
+        directory / "file", {.offset = data.size()}};
+    REQUIRE(end.span().empty());
+    REQUIRE(end.offset() == data.size());
+
+    const auto empty = fi::MemoryMappedFile{directory / "empty"};
+    REQUIRE(empty.span().empty());
+    REQUIRE(empty.offset() == 0);
+}
+
+TEST_CASE("Mapping past the end of a file fails", "[memory-mapped-file]")
+{
+    const auto directory = TempDirectory{};
+    writeBytes(directory / "file", makeData(5000, 2));
+
+    REQUIRE_THROWS_AS(
+        fi::MemoryMappedFile(directory / "file", {.offset = 5001}),
+        std::runtime_error);
+    REQUIRE_THROWS_AS(
+        fi::MemoryMappedFile(
+            directory / "file", {.offset = 1'000'000, .length = 0}),
+        std::runtime_error);
+    REQUIRE_THROWS_AS(
+        fi::MemoryMappedFile(directory / "missing"), std::runtime_error);
+}
+
+TEST_CASE("Prefetch parts of a mapped range", "[memory-mapped-file]")
+{
+    const auto directory = TempDirectory{};
+    const auto data = makeData(100'000, 4);
+    writeBytes(directory / "file", data);
+
+    const auto file = fi::MemoryMappedFile{
+        directory / "file", {.offset = 4097, .length = 50'000}};
+    const auto size = file.span().size();
+    REQUIRE(size == 50'000);
+
+    // Ranges relative to span(), clamped to it, of any alignment
+    REQUIRE_NOTHROW(file.prefetch());
+    REQUIRE_NOTHROW(file.prefetch(0, 1));
+    REQUIRE_NOTHROW(file.prefetch(1, 1));
+    REQUIRE_NOTHROW(file.prefetch(4095, 2));
+    REQUIRE_NOTHROW(file.prefetch(10'000, 100'000));
+    REQUIRE_NOTHROW(file.prefetch(size - 1));
+    REQUIRE_NOTHROW(file.prefetch(size));
+    REQUIRE_NOTHROW(file.prefetch(1'000'000, 1));
+    REQUIRE(equal(file.span(), expected(data, 4097, 50'000)));
+}
+
+TEST_CASE("Mapped ranges move with the file", "[memory-mapped-file]")
+{
+    const auto directory = TempDirectory{};
+    const auto data = makeData(10'000, 3);
+    writeBytes(directory / "file", data);
+
+    auto file = fi::MemoryMappedFile{
+        directory / "file", {.offset = 123, .length = 4000}};
+    auto moved = std::move(file);
+    REQUIRE(file.span().empty());
+    REQUIRE(file.offset() == 0);
+    REQUIRE(moved.offset() == 123);
+    REQUIRE(equal(moved.span(), expected(data, 123, 4000)));
+
+    moved.clear();
+    REQUIRE(moved.span().empty());
+}
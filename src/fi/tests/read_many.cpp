@@ -0,0 +1,100 @@
+#include "temp_directory.hpp"
+#include "test_data.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <fi/read_many.hpp>
+
+#include <cstddef>
+#include <filesystem>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct Files {
+    std::vector<fs::path> paths;
+    std::vector<std::vector<std::byte>> contents;
+};
+
+Files createFiles(const TempDirectory& directory, size_t count)
+{
+    auto files = Files{};
+    for (size_t i = 0; i < count; i++) {
+        files.contents.push_back(makeData(i * 37, i));
+        files.paths.push_back(directory / std::to_string(i));
+        writeBytes(files.paths.back(), files.contents.back());
+    }
+    return files;
+}
+
+} // namespace
+
+TEST_CASE("Read many files in order of paths", "[read-many]")
+{
+    const auto directory = TempDirectory{};
+    const auto files = createFiles(directory, 200);
+
+    for (size_t threads : {0, 1, 3, 8, 500}) {
+        REQUIRE(fi::readMany(files.paths, threads) == files.contents);
+    }
+    REQUIRE(fi::readMany(std::vector<fs::path>{}).empty());
+}
+
+TEST_CASE("Read many files through a callback", "[read-many]")
+{
+    const auto directory = TempDirectory{};
+    const auto files = createFiles(directory, 200);
+
+    auto seen = std::set<size_t>{};
+    bool matches = true;
+    const auto stats = fi::readMany(files.paths,
+        [&] (size_t index, std::vector<std::byte> data) {
+            matches = matches && data == files.contents.at(index);
+            seen.insert(index);
+        }, 4);
+
+    REQUIRE(matches);
+    REQUIRE(seen.size() == files.paths.size());
+    REQUIRE(stats.files == files.paths.size());
+    size_t bytes = 0;
+    for (const auto& data : files.contents) {
+        bytes += data.size();
+    }
+    REQUIRE(stats.bytes == bytes);
+}
+
+TEST_CASE("A missing file fails the batch", "[read-many]")
+{
+    const auto directory = TempDirectory{};
+    auto files = createFiles(directory, 100);
+    files.paths.at(50) = directory / "missing";
+
+    for (size_t threads : {1, 4}) {
+        REQUIRE_THROWS_AS(
+            fi::readMany(files.paths, threads), std::runtime_error);
+    }
+}
+
+TEST_CASE("A throwing callback fails the batch", "[read-many]")
+{
+    const auto directory = TempDirectory{};
+    const auto files = createFiles(directory, 100);
+
+    for (size_t threads : {1, 4}) {
+        size_t calls = 0;
+        REQUIRE_THROWS_AS(
+            fi::readMany(files.paths,
+                [&calls] (size_t, const std::vector<std::byte>&) {
+                    if (++calls == 10) {
+                        throw std::logic_error{"callback"};
+                    }
+                }, threads),
+            std::logic_error);
+        REQUIRE(calls == 10);
+    }
+}
@@ -0,0 +1,165 @@
+#include "temp_directory.hpp"
+#include "test_data.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <fi/fs.hpp>
+#include <fi/reader.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+std::vector<std::byte> readChunks(fi::Reader& reader, size_t maxChunk)
+{
+    auto data = std::vector<std::byte>{};
+    for (auto chunk = reader.next(); !chunk.empty(); chunk = reader.next()) {
+        REQUIRE(chunk.size() <= maxChunk);
+        data.insert(data.end(), chunk.begin(), chunk.end());
+    }
+    return data;
+}
+
+} // namespace
+
+TEST_CASE("Read whole files", "[reader]")
+{
+    const auto directory = TempDirectory{};
+    for (size_t size : {0, 1, 4095, 4096, 100'003}) {
+        const auto data = makeData(size, size);
+        writeBytes(directory / "file", data);
+        REQUIRE(fi::read<std::byte>(directory / "file") == data);
+    }
+    REQUIRE_THROWS_AS(
+        fi::read<std::byte>(directory / "missing"), std::runtime_error);
+}
+
+TEST_CASE("Chunks cross buffer boundaries", "[reader]")
+{
+    const auto directory = TempDirectory{};
+    const auto data = makeData(3 * 4096 + 100, 1);
+    writeBytes(directory / "file", data);
+
+    // Buffer sizes are rounded up to the direct I/O alignment
+    auto reader = fi::Reader{
+        directory / "file", fi::Reader::Mode::Buffered, 1000};
+    REQUIRE(reader.size() == data.size());
+
+    size_t chunks = 0;
+    auto read = std::vector<std::byte>{};
+    for (auto chunk = reader.next(); !chunk.empty(); chunk = reader.next()) {
+        REQUIRE(chunk.size() <= fi::Reader::directAlignment);
+        read.insert(read.end(), chunk.begin(), chunk.end());
+        chunks++;
+    }
+    REQUIRE(chunks == 4);
+    REQUIRE(read == data);
+    REQUIRE(reader.position() == data.size());
+    REQUIRE(reader.next().empty());
+}
+
+TEST_CASE("Seek moves the next chunk", "[reader]")
+{
+    const auto directory = TempDirectory{};
+    const auto data = makeData(10'000, 2);
+    writeBytes(directory / "file", data);
+
+    for (auto mode : {fi::Reader::Mode::Buffered, fi::Reader::Mode::Direct}) {
+        auto reader = fi::Reader{directory / "file", mode, 4096};
+        reader.seek(5'000);
+        REQUIRE(reader.position() == 5'000);
+        const auto rest = readChunks(reader, 4096);
+        REQUIRE(std::equal(
+            rest.begin(), rest.end(), data.begin() + 5'000, data.end()));
+
+        reader.seek(data.size() + 10);
+        REQUIRE(reader.next().empty());
+    }
+}
+
+TEST_CASE("Read at an offset stops at the end of the file", "[reader]")
+{
+    const auto directory = TempDirectory{};
+    const auto data = makeData(1'000, 3);
+    writeBytes(directory / "file", data);
+
+    auto reader = fi::Reader{directory / "file"};
+    auto buffer = std::vector<std::byte>(100);
+    REQUIRE(reader.readAt(990, buffer) == 10);
+    REQUIRE(std::equal(data.begin() + 990, data.end(), buffer.begin()));
+    REQUIRE(reader.readAt(1'000, buffer) == 0);
+    REQUIRE(reader.readAt(5'000, buffer) == 0);
+    REQUIRE(reader.position() == 0);
+}
+
+TEST_CASE("A reader keeps its buffer for another file", "[reader]")
+{
+    const auto directory = TempDirectory{};
+    const auto first = makeData(5'000, 4);
+    const auto second = makeData(7'000, 5);
+    writeBytes(directory / "first", first);
+    writeBytes(directory / "second", second);
+
+    auto reader = fi::Reader{};
+    REQUIRE(!reader.isOpen());
+    REQUIRE_THROWS_AS(reader.next(), std::logic_error);
+
+    reader.open(directory / "first");
+    REQUIRE(readChunks(reader, fi::Reader::defaultBufferSize) == first);
+    reader.open(directory / "second");
+    REQUIRE(reader.position() == 0);
+    REQUIRE(readChunks(reader, fi::Reader::defaultBufferSize) == second);
+}
+
+TEST_CASE("Read into caller memory", "[reader]")
+{
+    const auto directory = TempDirectory{};
+    const auto data = makeData(1'000, 6);
+    writeBytes(directory / "file", data);
+
+    auto buffer = std::vector<std::byte>(2'000);
+    REQUIRE(fi::readInto(directory / "file", std::span{buffer}) == 1'000);
+    REQUIRE(std::equal(data.begin(), data.end(), buffer.begin()));
+
+    auto small = std::vector<std::byte>(999);
+    REQUIRE_THROWS_AS(
+        fi::readInto(directory / "file", std::span{small}),
+        std::runtime_error);
+
+    auto ints = std::vector<uint32_t>(250);
+    REQUIRE(fi::readInto(directory / "file", std::span{ints}) == 250);
+
+    writeBytes(directory / "odd", makeData(10, 7));
+    REQUIRE_THROWS_AS(
+        fi::readInto(directory / "odd", std::span{ints}), std::runtime_error);
+}
+
+TEST_CASE("Direct reads", "[reader]")
+{
+    const auto directory = TempDirectory{};
+    const auto data = makeData(3 * 4096 + 7, 8);
+    writeBytes(directory / "file", data);
+
+    auto reader = fi::Reader{directory / "file", fi::Reader::Mode::Direct};
+    REQUIRE(readChunks(reader, fi::Reader::defaultBufferSize) == data);
+
+    if (reader.isDirect()) {
+        auto buffer = std::vector<std::byte>(100);
+        REQUIRE_THROWS_AS(reader.readAt(1, buffer), std::invalid_argument);
+    }
+}
+
+#ifdef __linux__
+TEST_CASE("Direct reads fall back where they are not supported", "[reader]")
+{
+    // procfs refuses O_DIRECT, and reports files as empty
+    auto reader = fi::Reader{"/proc/version", fi::Reader::Mode::Direct};
+    REQUIRE(!reader.isDirect());
+    REQUIRE(!readChunks(reader, fi::Reader::defaultBufferSize).empty());
+}
+#endif
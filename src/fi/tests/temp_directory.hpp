@@ -0,0 +1,42 @@
+#pragma once
+
+#include <filesystem>
+#include <random>
+#include <string>
+
+// Directory of its own for a test, removed with everything in it afterwards
+class TempDirectory {
+public:
+    TempDirectory()
+    {
+        auto random = std::random_device{};
+        do {
+            _path = std::filesystem::temp_directory_path() /
+                ("fi-tests-" + std::to_string(random()));
+        } while (!std::filesystem::create_directory(_path));
+    }
+
+    TempDirectory(const TempDirectory&) = delete;
+    TempDirectory(TempDirectory&&) = delete;
+    TempDirectory& operator=(const TempDirectory&) = delete;
+    TempDirectory& operator=(TempDirectory&&) = delete;
+
+    ~TempDirectory()
+    {
+        auto error = std::error_code{};
+        std::filesystem::remove_all(_path, error);
+    }
+
+    [[nodiscard]] const std::filesystem::path& path() const
+    {
+        return _path;
+    }
+
+    std::filesystem::path operator/(const std::string& name) const
+    {
+        return _path / name;
+    }
+
+private:
+    std::filesystem::path _path;
+};
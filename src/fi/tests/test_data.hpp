@@ -0,0 +1,33 @@
+#pragma once
+
+#include <fi/fs.hpp>
+
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+// Bytes that differ with the seed, and do not repeat with a period of a
+// power of two, so that misplaced blocks show up
+inline std::vector<std::byte> makeData(size_t size, size_t seed)
+{
+    auto data = std::vector<std::byte>(size);
+    for (size_t i = 0; i < size; i++) {
+        data[i] = static_cast<std::byte>((i * 31 + seed) % 251);
+    }
+    return data;
+}
+
+inline void writeBytes(
+    const std::filesystem::path& path, const std::vector<std::byte>& data)
+{
+    fi::write(path, std::span<const std::byte>{data});
+}
+
+inline bool equal(
+    std::span<const std::byte> lhs, std::span<const std::byte> rhs)
+{
+    return lhs.size() == rhs.size() &&
+        (lhs.empty() || std::memcmp(lhs.data(), rhs.data(), lhs.size()) == 0);
+}
@@ -0,0 +1,189 @@
+#include "temp_directory.hpp"
+#include "test_data.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <fi/fs.hpp>
+#include <fi/writable_mapped_file.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+namespace {
+
+bool isZero(std::span<const std::byte> data)
+{
+    for (auto byte : data) {
+        if (byte != std::byte{0}) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+TEST_CASE("Writable mapped files grow geometrically", "[writable-mapped-file]")
+{
+    const auto directory = TempDirectory{};
+    const auto data = makeData(300'001, 5);
+
+    auto file = fi::WritableMappedFile{directory / "file", {}, 1};
+    const auto pageCapacity = file.capacity();
+    REQUIRE(pageCapacity > 0);
+    REQUIRE(file.size() == 0);
+
+    size_t growths = 0;
+    for (size_t offset = 0; offset < data.size(); offset += 1000) {
+        const auto size = std::min<size_t>(1000, data.size() - offset);
+        const auto capacity = file.capacity();
+        file.write(std::span{data}.subspan(offset, size));
+        if (file.capacity() != capacity) {
+            // At least doubled, so that appending is amortized
+            REQUIRE(file.capacity() >= 2 * capacity);
+            growths++;
+        }
+        REQUIRE(file.capacity() >= file.size());
+    }
+    REQUIRE(growths <= 10);
+    REQUIRE(file.capacity() < 2 * data.size() + pageCapacity);
+
+    // Growing may move the mapping, so spans are taken again afterwards
+    REQUIRE(equal(file.span(), data));
+    file.close();
+    REQUIRE(fi::read<std::byte>(directory / "file") == data);
+}
+
+TEST_CASE("Bytes filled in place survive growth", "[writable-mapped-file]")
+{
+    const auto directory = TempDirectory{};
+    const auto data = makeData(10'000, 9);
+
+    auto file = fi::WritableMappedFile{directory / "file", {}, 1};
+    auto head = file.extend(100);
+    std::memcpy(head.data(), data.data(), head.size());
+
+    const auto capacity = file.capacity();
+    file.reserve(16 * capacity);
+    REQUIRE(file.capacity() == 16 * capacity);
+    REQUIRE(file.size() == 100);
+
+    // head may dangle now
+    auto tail = file.extend(data.size() - 100);
+    std::memcpy(tail.data(), data.data() + 100, tail.size());
+    REQUIRE(equal(file.span(), data));
+}
+
+TEST_CASE("Keep mode appends to existing files", "[writable-mapped-file]")
+{
+    const auto directory = TempDirectory{};
+    const auto data = makeData(5000, 3);
+    writeBytes(directory / "file", std::vector(data.begin(), data.end() - 100));
+
+    {
+        auto file = fi::WritableMappedFile{
+            directory / "file", fi::WritableMappedFile::Mode::Keep};
+        REQUIRE(file.size() == data.size() - 100);
+        REQUIRE(equal(file.span(), std::span{data}.first(file.size())));
+        file.write(std::span{data}.last(100));
+    }
+    REQUIRE(fi::read<std::byte>(directory / "file") == data);
+
+    {
+        auto file = fi::WritableMappedFile{
+            directory / "file", fi::WritableMappedFile::Mode::Truncate};
+        REQUIRE(file.size() == 0);
+    }
+    REQUIRE(std::filesystem::file_size(directory / "file") == 0);
+
+    {
+        auto file = fi::WritableMappedFile{
+            directory / "new", fi::WritableMappedFile::Mode::Keep};
+        REQUIRE(file.size() == 0);
+    }
+    REQUIRE(std::filesystem::exists(directory / "new"));
+}
+
+TEST_CASE("Resizing past old data zeroes it", "[writable-mapped-file]")
+{
+    const auto directory = TempDirectory{};
+    const auto data = makeData(3000, 1);
+
+    auto file = fi::WritableMappedFile{directory / "file", {}, 1};
+    file.write(data);
+    file.resize(1000);
+    REQUIRE(equal(file.span(), std::span{data}.first(1000)));
+
+    // Below the high-water mark, the old bytes are still in the mapping
+    file.resize(2000);
+    REQUIRE(equal(file.span().first(1000), std::span{data}.first(1000)));
+    REQUIRE(isZero(file.span().subspan(1000)));
+
+    // Across it and past the capacity, so the file is extended too
+    file.resize(1500);
+    file.resize(5 * file.capacity());
+    REQUIRE(equal(file.span().first(1000), std::span{data}.first(1000)));
+    REQUIRE(isZero(file.span().subspan(1000)));
+
+    // Keep mode starts with the high-water mark at the end of the file
+    file.close();
+    writeBytes(directory / "file", data);
+    file = fi::WritableMappedFile{
+        directory / "file", fi::WritableMappedFile::Mode::Keep};
+    file.resize(10);
+    file.resize(3000);
+    REQUIRE(equal(file.span().first(10), std::span{data}.first(10)));
+    REQUIRE(isZero(file.span().subspan(10)));
+}
+
+TEST_CASE("Flush ranges that are not page aligned", "[writable-mapped-file]")
+{
+    const auto directory = TempDirectory{};
+    const auto data = makeData(20'000, 4);
+
+    auto file = fi::WritableMappedFile{directory / "file"};
+    file.write(data);
+    REQUIRE_NOTHROW(file.flush(100, 50));
+    REQUIRE_NOTHROW(file.flush(4095, 2));
+    REQUIRE_NOTHROW(file.flush(4097));
+    REQUIRE_NOTHROW(file.flush(19'999, 1, false));
+    REQUIRE_NOTHROW(file.flush(5000, 1'000'000));
+    REQUIRE_NOTHROW(file.flush());
+
+    // Nothing to write back at or past the end
+    REQUIRE_NOTHROW(file.flush(20'000));
+    REQUIRE_NOTHROW(file.flush(1'000'000, 1));
+
+    // The mapping is shared, so the file has the data before close()
+    const auto contents = fi::read<std::byte>(directory / "file");
+    REQUIRE(contents.size() == file.capacity());
+    REQUIRE(equal(std::span{contents}.first(data.size()), data));
+}
+
+TEST_CASE("Closing trims the file to its size", "[writable-mapped-file]")
+{
+    const auto directory = TempDirectory{};
+    const auto data = makeData(1234, 2);
+
+    auto file = fi::WritableMappedFile{directory / "file"};
+    file.write(data);
+    REQUIRE(
+        std::filesystem::file_size(directory / "file") == file.capacity());
+
+    file.close();
+    REQUIRE(!file.isOpen());
+    REQUIRE(file.size() == 0);
+    REQUIRE(fi::read<std::byte>(directory / "file") == data);
+
+    // Again, and shrinking
+    REQUIRE_NOTHROW(file.close());
+    file = fi::WritableMappedFile{
+        directory / "file", fi::WritableMappedFile::Mode::Keep};
+    file.resize(10);
+    file = fi::WritableMappedFile{};
+    REQUIRE(std::filesystem::file_size(directory / "file") == 10);
+}
@@ -0,0 +1,341 @@
+#include <fi/writable_mapped_file.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace fi {
+
+namespace {
+
+size_t pageSize()
+{
+#ifdef __linux__
+    static const auto pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return pageSize;
+#elif defined(_WIN32)
+    static const auto pageSize = [] {
+        SYSTEM_INFO info{};
+        GetSystemInfo(&info);
+        return static_cast<size_t>(info.dwPageSize);
+    }();
+    return pageSize;
+#endif
+}
+
+size_t roundUp(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+#ifdef _WIN32
+bool setFileSize(HANDLE file, size_t size)
+{
+    auto position = LARGE_INTEGER{};
+    position.QuadPart = static_cast<LONGLONG>(size);
+    return SetFilePointerEx(file, position, nullptr, FILE_BEGIN) &&
+        SetEndOfFile(file);
+}
+#endif
+
+} // namespace
+
+WritableMappedFile::WritableMappedFile(
+    const fs::path& path, Mode mode, size_t capacity)
+    : _path(path)
+{
+#ifdef __linux__
+    int flags = O_RDWR | O_CREAT | O_CLOEXEC;
+    if (mode == Mode::Truncate) {
+        flags |= O_TRUNC;
+    }
+    _fd = open(path.string().c_str(), flags, 0644); // NOLINT
+    if (_fd == -1) {
+        throw std::runtime_error{
+            "WritableMappedFile: failed to open file: " + path.string()};
+    }
+
+    struct stat sb{};
+    if (fstat(_fd, &sb) == -1) {
+        ::close(_fd);
+        _fd = -1;
+        throw std::runtime_error{
+            "WritableMappedFile: failed to fstat file: " + path.string()};
+    }
+    _size = static_cast<size_t>(sb.st_size);
+#elif defined(_WIN32)
+    _fileHandle = CreateFile(
+        path.string().c_str(),
+        GENERIC_READ | GENERIC_WRITE,
+        FILE_SHARE_READ,
+        nullptr,
+        mode == Mode::Truncate ? CREATE_ALWAYS : OPEN_ALWAYS,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr);
+    if (_fileHandle == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error{
+            "WritableMappedFile: CreateFile failed: " +
+            std::to_string(GetLastError()) + ": " + path.string()};
+    }
+
+    auto size = LARGE_INTEGER{};
+    if (!GetFileSizeEx(_fileHandle, &size)) {
+        CloseHandle(_fileHandle);
+        _fileHandle = INVALID_HANDLE_VALUE;
+        throw std::runtime_error{
+            "WritableMappedFile: GetFileSizeEx failed: " +
+            std::to_string(GetLastError()) + ": " + path.string()};
+    }
+    _size = static_cast<size_t>(size.QuadPart);
+#endif
+
+    _highWater = _size;
+    try {
+        map(std::max(capacity, _size));
+    } catch (...) {
+        close();
+        throw;
+    }
+}
+
+WritableMappedFile::WritableMappedFile(WritableMappedFile&& other) noexcept
+#ifdef __linux__
+    : _fd(std::exchange(other._fd, -1))
+#elif defined(_WIN32)
+    : _fileHandle(std::exchange(other._fileHandle, INVALID_HANDLE_VALUE))
+    , _fileMappingHandle(
+        std::exchange(other._fileMappingHandle, INVALID_HANDLE_VALUE))
+#endif
+    , _path(std::move(other._path))
+    , _mapping(std::exchange(other._mapping, nullptr))
+    , _capacity(std::exchange(other._capacity, 0))
+    , _size(std::exchange(other._size, 0))
+    , _highWater(std::exchange(other._highWater, 0))
+{ }
+
+WritableMappedFile::~WritableMappedFile()
+{
+    try {
+        close();
+    } catch (...) {
+        // Destructor must not throw; call close() to observe errors
+    }
+}
+
+WritableMappedFile& WritableMappedFile::operator=(
+    WritableMappedFile&& other) noexcept
+{
+    if (this != &other) {
+        try {
+            close();
+        } catch (...) {
+            // Same as in the destructor
+        }
+
+#ifdef __linux__
+        std::swap(_fd, other._fd);
+#elif defined(_WIN32)
+        std::swap(_fileHandle, other._fileHandle);
+        std::swap(_fileMappingHandle, other._fileMappingHandle);
+#endif
+        std::swap(_path, other._path);
+        std::swap(_mapping, other._mapping);
+        std::swap(_capacity, other._capacity);
+        std::swap(_size, other._size);
+        std::swap(_highWater, other._highWater);
+    }
+    return *this;
+}
+
+bool WritableMappedFile::isOpen() const
+{
+#ifdef __linux__
+    return _fd != -1;
+#elif defined(_WIN32)
+    return _fileHandle != INVALID_HANDLE_VALUE;
+#endif
+}
+
+std::span<std::byte> WritableMappedFile::span()
+{
+    return {_mapping, _size};
+}
+
+std::span<const std::byte> WritableMappedFile::span() const
+{
+    return {_mapping, _size};
+}
+
+size_t WritableMappedFile::size() const
+{
+    return _size;
+}
+
+size_t WritableMappedFile::capacity() const
+{
+    return _capacity;
+}
+
+void WritableMappedFile::reserve(size_t capacity)
+{
+    if (!isOpen()) {
+        throw std::logic_error{"WritableMappedFile: file is not open"};
+    }
+    map(capacity);
+}
+
+void WritableMappedFile::resize(size_t size)
+{
+    if (size > _capacity) {
+        reserve(std::max(size, 2 * _capacity));
+    }
+
+    // Bytes past the high-water mark are still zero from extending the file
+    if (size > _size && _size < _highWater) {
+        std::memset(_mapping + _size, 0, std::min(size, _highWater) - _size);
+    }
+    _size = size;
+    _highWater = std::max(_highWater, size);
+}
+
+std::span<std::byte> WritableMappedFile::extend(size_t size)
+{
+    auto offset = _size;
+    resize(_size + size);
+    return {_mapping + offset, size};
+}
+
+void WritableMappedFile::write(std::span<const std::byte> data)
+{
+    if (!data.empty()) {
+        std::memcpy(extend(data.size()).data(), data.data(), data.size());
+    }
+}
+
+void WritableMappedFile::flush(size_t offset, size_t length, bool wait)
+{
+    if (offset >= _size) {
+        return;
+    }
+    length = std::min(length, _size - offset);
+
+    auto begin = offset - offset % pageSize();
+    auto end = offset + length;
+
+#ifdef __linux__
+    if (msync(_mapping + begin, end - begin, wait ? MS_SYNC : MS_ASYNC) != 0) {
+        throw std::runtime_error{
+            "WritableMappedFile: failed to flush file: " + _path.string()};
+    }
+#elif defined(_WIN32)
+    if (!FlushViewOfFile(_mapping + begin, end - begin) ||
+            (wait && !FlushFileBuffers(_fileHandle))) {
+        throw std::runtime_error{
+            "WritableMappedFile: failed to flush file: " + _path.string()};
+    }
+#endif
+}
+
+void WritableMappedFile::close()
+{
+    if (!isOpen()) {
+        return;
+    }
+
+    unmap();
+#ifdef __linux__
+    bool trimmed = ftruncate(_fd, static_cast<off_t>(_size)) == 0;
+    ::close(_fd);
+    _fd = -1;
+#elif defined(_WIN32)
+    bool trimmed = setFileSize(_fileHandle, _size);
+    CloseHandle(_fileHandle);
+    _fileHandle = INVALID_HANDLE_VALUE;
+#endif
+    _size = 0;
+    _highWater = 0;
+
+    if (!trimmed) {
+        throw std::runtime_error{
+            "WritableMappedFile: failed to trim file: " + _path.string()};
+    }
+}
+
+void WritableMappedFile::map(size_t capacity)
+{
+    capacity = roundUp(capacity, pageSize());
+    if (capacity <= _capacity) {
+        return;
+    }
+
+#ifdef __linux__
+    if (ftruncate(_fd, static_cast<off_t>(capacity)) != 0) {
+        throw std::runtime_error{
+            "WritableMappedFile: failed to extend file: " + _path.string()};
+    }
+
+    void* address = _mapping ?
+        mremap(_mapping, _capacity, capacity, MREMAP_MAYMOVE) :
+        mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+    if (address == MAP_FAILED) {
+        throw std::runtime_error{
+            "WritableMappedFile: failed to map file: " + _path.string()};
+    }
+#elif defined(_WIN32)
+    // A view cannot grow, so the file is mapped again
+    unmap();
+    if (!setFileSize(_fileHandle, capacity)) {
+        throw std::runtime_error{
+            "WritableMappedFile: failed to extend file: " + _path.string()};
+    }
+
+    _fileMappingHandle = CreateFileMapping(
+        _fileHandle, NULL, PAGE_READWRITE, 0, 0, NULL);
+    if (_fileMappingHandle == NULL) {
+        _fileMappingHandle = INVALID_HANDLE_VALUE;
+        throw std::runtime_error{
+            "WritableMappedFile: failed to map file: " + _path.string()};
+    }
+    void* address =
+        MapViewOfFile(_fileMappingHandle, FILE_MAP_WRITE, 0, 0, capacity);
+    if (!address) {
+        throw std::runtime_error{
+            "WritableMappedFile: failed to map file: " + _path.string()};
+    }
+#endif
+
+    _mapping = static_cast<std::byte*>(address);
+    _capacity = capacity;
+}
+
+void WritableMappedFile::unmap() noexcept
+{
+#ifdef __linux__
+    if (_mapping) {
+        munmap(_mapping, _capacity);
+    }
+#elif defined(_WIN32)
+    if (_mapping) {
+        UnmapViewOfFile(_mapping);
+    }
+    if (_fileMappingHandle != INVALID_HANDLE_VALUE) {
+        CloseHandle(_fileMappingHandle);
+        _fileMappingHandle = INVALID_HANDLE_VALUE;
+    }
+#endif
+    _mapping = nullptr;
+    _capacity = 0;
+}
+
+} // namespace fi
@@ -0,0 +1,58 @@
+#include <fi/writer.hpp>
+
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+namespace fi {
+
+Writer::Writer(const fs::path& path, size_t bufferSize)
+{
+    _output.exceptions(std::ios::badbit | std::ios::failbit);
+    try {
+        _output.open(path, std::ios::binary | std::ios::trunc);
+    } catch (const std::ios::failure&) {
+        throw std::runtime_error{
+            "Writer: failed to open file: " + path.string()};
+    }
+    _buffer.reserve(bufferSize);
+}
+
+Writer::~Writer()
+{
+    try {
+        if (_output.is_open()) {
+            flush();
+        }
+    } catch (...) {
+        // Destructor must not throw; call flush() to observe errors
+    }
+}
+
+void Writer::write(std::span<const std::byte> data)
+{
+    if (_buffer.size() + data.size() > _buffer.capacity()) {
+        flush();
+    }
+
+    if (data.size() >= _buffer.capacity()) {
+        _output.write(
+            reinterpret_cast<const char*>(data.data()),
+            static_cast<std::streamsize>(data.size()));
+    } else {
+        _buffer.insert(_buffer.end(), data.begin(), data.end());
+    }
+}
+
+void Writer::flush()
+{
+    if (!_buffer.empty()) {
+        _output.write(
+            reinterpret_cast<const char*>(_buffer.data()),
+            static_cast<std::streamsize>(_buffer.size()));
+        _buffer.clear();
+    }
+    _output.flush();
+}
+
+} // namespace fi
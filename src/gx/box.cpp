@@ -2,6 +2,8 @@
 
 #include <gx/error.hpp>
 
+#include <tempo/profiler.hpp>
+
 #include <SDL_image.h>
 
 #include <ranges>
@@ -45,6 +47,7 @@ void Box::setCursor(Cursor& cursor)
 
 void Box::update(float delta)
 {
+    TEMPO_SCOPE("Box::update");
     for (const auto& widget : _widgets) {
         widget->update(delta);
     }
@@ -52,6 +55,7 @@ void Box::update(float delta)
 
 void Box::present()
 {
+    TEMPO_SCOPE("Box::present");
     _renderer.clear();
     for (const auto& widget : _widgets) {
         widget->render(_renderer, _renderer.windowArea());
@@ -1,4 +1,6 @@
+#include <fi.hpp>
 #include <gx.hpp>
+#include <tempo.hpp>
 
 #include <SDL.h>
 
@@ -7,7 +9,6 @@
 #include <filesystem>
 #include <map>
 #include <ostream>
-#include <thread>
 
 #include <iostream>
 
@@ -392,31 +393,33 @@ Resources loadResources(gx::Box& box)
     auto r = Resources{};
 
     const auto root = executableDirectory();
+    const auto assets = fi::Archive{root / "assets.pack"};
 
-    r.bitmaps.grass = box.loadBitmap(root / "grass.png");
+    r.bitmaps.grass = box.loadBitmap(assets.at("grass.png"));
     r.sprites.grass = gx::createSimpleSprite(r.bitmaps.grass, 2, 3);
 
-    r.bitmaps.tree = box.loadBitmap(root / "tree.png");
+    r.bitmaps.tree = box.loadBitmap(assets.at("tree.png"));
     r.sprites.tree = gx::createSimpleSprite(r.bitmaps.tree, 2, 3);
 
-    r.bitmaps.hero = box.loadBitmap(root / "hero.png");
+    r.bitmaps.hero = box.loadBitmap(assets.at("hero.png"));
     r.sprites.hero = gx::createSimpleSprite(r.bitmaps.hero);
 
-    r.bitmaps.stone = box.loadBitmap(root / "stone.png");
+    r.bitmaps.stone = box.loadBitmap(assets.at("stone.png"));
     r.sprites.stone = gx::createSimpleSprite(r.bitmaps.stone);
 
-    r.bitmaps.bullet = box.loadBitmap(root / "bullet.png");
+    r.bitmaps.bullet = box.loadBitmap(assets.at("bullet.png"));
     r.sprites.bullet = gx::createSimpleSprite(r.bitmaps.bullet);
 
     r.cursor = gx::Box::loadCursor(root / "cursor.png", 2, 0);
 
-    r.bitmaps.button = box.loadBitmap(root / "button.png");
+    r.bitmaps.button = box.loadBitmap(assets.at("button.png"));
     r.sprites.buttonNormal =
         gx::createOneFrameSprite(r.bitmaps.button, {0, 0, 64, 16}, 3);
     r.sprites.buttonPressed =
         gx::createOneFrameSprite(r.bitmaps.button, {0, 16, 64, 16}, 3);
 
-    r.bitmaps.pressAnimation = box.loadBitmap(root / "press-animation.png");
+    r.bitmaps.pressAnimation =
+        box.loadBitmap(assets.at("press-animation.png"));
     r.sprites.pressAnimation =
         gx::createSimpleSprite(r.bitmaps.pressAnimation, 7, 14);
 
@@ -428,44 +431,19 @@ Resources loadResources(gx::Box& box)
     return r;
 }
 
-class Timer {
-    using Clock = std::chrono::high_resolution_clock;
-
-public:
-    Timer(int fps)
-        : _delta(1.f / (float)fps)
-        , _frameDuration(std::chrono::duration_cast<Clock::duration>(
-            std::chrono::duration<float>(_delta)))
-        , _start(Clock::now())
-    { }
-
-    float delta() const
-    {
-        return _delta;
-    }
-
-    int operator()()
-    {
-        auto now = Clock::now();
-        size_t frame = (now - _start) / _frameDuration;
-        int framesPassed = static_cast<int>(frame - _lastFrame);
-        _lastFrame = frame;
-        return framesPassed;
-    }
-
-    void relax() const
-    {
-        std::this_thread::sleep_until(
-            _start + _frameDuration * (_lastFrame + 1));
-    }
-
-private:
-    float _delta = 0.f;
-    Clock::duration _frameDuration;
-    Clock::time_point _start;
-    size_t _lastFrame = 0;
+// Scene object with the positions from the last two simulation steps, to
+// draw it in between
+struct Tracked {
+    gx::Object* object = nullptr;
+    Vector previous;
+    Vector current;
 };
 
+Vector lerp(const Vector& from, const Vector& to, float alpha)
+{
+    return from + (to - from) * alpha;
+}
+
 int main()
 {
     auto world = World{};
@@ -487,7 +465,7 @@ int main()
         ->textSprite(r.sprites.quitTextSprite)
         ->action([&quitRequested] { quitRequested = true; });
 
-    std::map<size_t, gx::Object*> objects;
+    std::map<size_t, Tracked> objects;
 
     auto* hero = scene->spawn(r.sprites.hero, gx::WorldPoint{0, 0});
     scene->setupCamera(gx::WorldPoint{0, 0}, 16, 4);
@@ -496,67 +474,86 @@ int main()
         world.shootInDirectionOf({point.x, point.y});
     });
 
-    static constexpr int fps = 60;
-    auto timer = Timer{fps};
+    // Simulate at a fixed rate, and render at the display rate
+    static constexpr int updatesPerSecond = 30;
+    auto loop = tempo::Loop{updatesPerSecond};
+    auto heroPrevious = world.heroPosition;
 
-    for (;;) {
-        for (SDL_Event e; SDL_PollEvent(&e); ) {
-            box.processEvent(e) || world.processEvent(e);
-        }
-        if (box.dead() || quitRequested) {
-            break;
+    auto update = [&] (double delta) {
+        heroPrevious = world.heroPosition;
+        for (auto& [id, tracked] : objects) {
+            tracked.previous = tracked.current;
         }
 
-        if (int framesPassed = timer(); framesPassed > 0) {
-            // Update world with the same delta for perfect reproducibility
-            for (int i = 0; i < framesPassed; i++) {
-                world.update((float)timer.delta());
-            }
+        world.update((float)delta);
 
-            for (const auto& message : messages) {
-                if (auto it = objects.find(message.objectId);
-                        it != objects.end()) {
-                    auto* object = it->second;
-                    if (!message.alive) {
-                        object->kill = true;
-                        objects.erase(it);
-                    } else {
-                        object->position = {message.x, message.y};
-                    }
+        for (const auto& message : messages) {
+            if (auto it = objects.find(message.objectId);
+                    it != objects.end()) {
+                auto& tracked = it->second;
+                if (!message.alive) {
+                    tracked.object->kill = true;
+                    objects.erase(it);
                 } else {
-                    gx::Sprite* sprite = nullptr;
-                    switch (message.type) {
-                        case ObjectType::Stone:
-                            sprite = &r.sprites.stone;
-                            break;
-                        case ObjectType::Tree:
-                            sprite = &r.sprites.tree;
-                            break;
-                        case ObjectType::Hero:
-                            sprite = &r.sprites.hero;
-                            break;
-                        case ObjectType::Bullet:
-                            sprite = &r.sprites.bullet;
-                            break;
-                        default:
-                            break;
-                    }
-
-                    if (sprite) {
-                        auto* object = scene->spawn(
-                            *sprite, {message.x, message.y});
-                        objects.emplace(message.objectId, object);
-                    }
+                    tracked.current = {message.x, message.y};
+                }
+            } else {
+                gx::Sprite* sprite = nullptr;
+                switch (message.type) {
+                    case ObjectType::Stone:
+                        sprite = &r.sprites.stone;
+                        break;
+                    case ObjectType::Tree:
+                        sprite = &r.sprites.tree;
+                        break;
+                    case ObjectType::Hero:
+                        sprite = &r.sprites.hero;
+                        break;
+                    case ObjectType::Bullet:
+                        sprite = &r.sprites.bullet;
+                        break;
+                    default:
+                        break;
+                }
+
+                if (sprite) {
+                    auto position = Vector{message.x, message.y};
+                    auto* object = scene->spawn(
+                        *sprite, {position.x, position.y});
+                    objects.emplace(message.objectId, Tracked{
+                        .object = object,
+                        .previous = position,
+                        .current = position,
+                    });
                 }
             }
-            messages.clear();
+        }
+        messages.clear();
+    };
 
-            hero->position = {world.heroPosition.x, world.heroPosition.y};
+    auto render = [&] (double alpha) {
+        for (auto& [id, tracked] : objects) {
+            auto position =
+                lerp(tracked.previous, tracked.current, (float)alpha);
+            tracked.object->position = {position.x, position.y};
+        }
+        auto heroPosition =
+            lerp(heroPrevious, world.heroPosition, (float)alpha);
+        hero->position = {heroPosition.x, heroPosition.y};
+
+        box.update((float)loop.frameTime());
+        box.present();
+    };
 
-            box.update(timer.delta() * (float)framesPassed);
-            box.present();
+    for (;;) {
+        for (SDL_Event e; SDL_PollEvent(&e); ) {
+            box.processEvent(e) || world.processEvent(e);
+        }
+        if (box.dead() || quitRequested) {
+            break;
         }
 
-        timer.relax();
+        // Presenting waits for vertical sync, which paces the loop
+        loop.frame(update, render);
     }
 }
@@ -1,5 +1,7 @@
 #include <gx/scene.hpp>
 
+#include <tempo/profiler.hpp>
+
 #include <cmath>
 #include <utility>
 
@@ -62,6 +64,7 @@ void Scene::update(float delta)
 
 void Scene::render(Renderer& renderer, const ScreenRectangle& area) const
 {
+    TEMPO_SCOPE("Scene::render");
     for (const auto& object : _objects) {
         auto objectOffset = _camera.worldPointToScreenOffset(object->position);
         auto objectPosition = area.middlePoint() + objectOffset;
@@ -0,0 +1,64 @@
+#include <tempo/chrome_trace.hpp>
+
+#include <array>
+
+namespace tempo {
+
+void writeJsonString(std::ostream& output, std::string_view string)
+{
+    constexpr auto hexDigits = std::array{
+        '0', '1', '2', '3', '4', '5', '6', '7',
+        '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'};
+
+    output << '"';
+    for (char c : string) {
+        const auto byte = static_cast<unsigned char>(c);
+        if (c == '"' || c == '\\') {
+            output << '\\' << c;
+        } else if (byte < 0x20) {
+            output << "\\u00" << hexDigits.at(byte >> 4U) <<
+                hexDigits.at(byte & 0xfU);
+        } else {
+            output << c;
+        }
+    }
+    output << '"';
+}
+
+ChromeTraceWriter::ChromeTraceWriter(
+    std::ostream& output, std::string_view category)
+    : _output(output)
+    , _category(category)
+{
+    _output << "{\"traceEvents\":[";
+}
+
+ChromeTraceWriter::~ChromeTraceWriter()
+{
+    _output << "],\"displayTimeUnit\":\"ns\"}";
+}
+
+void ChromeTraceWriter::write(const Event& event)
+{
+    _output << (_first ? "" : ",");
+    _first = false;
+
+    _output << "{\"name\":";
+    writeJsonString(_output, event.name);
+    _output << ",\"cat\":";
+    writeJsonString(_output, _category);
+    _output <<
+        ",\"ph\":\"X\",\"pid\":0,\"tid\":" << event.thread <<
+        ",\"ts\":" << event.start.count() <<
+        ",\"dur\":" << event.duration.count();
+    if (!event.argumentKey.empty()) {
+        _output << ",\"args\":{";
+        writeJsonString(_output, event.argumentKey);
+        _output << ':';
+        writeJsonString(_output, event.argumentValue);
+        _output << '}';
+    }
+    _output << '}';
+}
+
+} // namespace tempo
@@ -0,0 +1,143 @@
+#include <tempo/fast_clock.hpp>
+
+#include <atomic>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define TEMPO_FAST_CLOCK_TSC
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+
+namespace tempo {
+
+namespace {
+
+using Steady = std::chrono::steady_clock;
+
+constexpr auto calibrationTime = std::chrono::milliseconds{10};
+
+std::atomic<FastClock::rep> frameTime = 0;
+
+FastClock::rep steadyNow() noexcept
+{
+    return std::chrono::duration_cast<FastClock::duration>(
+        Steady::now().time_since_epoch()).count();
+}
+
+#ifdef TEMPO_FAST_CLOCK_TSC
+
+__extension__ using Wide = __int128;
+
+// Nanoseconds are baseTime + ((counter - baseCounter) * multiplier >> 32)
+struct Calibration {
+    bool tsc = false;
+    double frequency = 0.0;
+    uint64_t baseCounter = 0;
+    FastClock::rep baseTime = 0;
+    uint64_t multiplier = 0;
+};
+
+bool invariantTsc()
+{
+    unsigned eax = 0;
+    unsigned ebx = 0;
+    unsigned ecx = 0;
+    unsigned edx = 0;
+    if (__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) == 0 ||
+            eax < 0x80000007) {
+        return false;
+    }
+    __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+    return (edx & (1U << 8U)) != 0;
+}
+
+Calibration calibrate()
+{
+    auto calibration = Calibration{};
+    if (!invariantTsc()) {
+        return calibration;
+    }
+
+    auto startTime = Steady::now();
+    auto startCounter = __rdtsc();
+    auto endTime = startTime;
+    while (endTime - startTime < calibrationTime) {
+        endTime = Steady::now();
+    }
+    auto endCounter = __rdtsc();
+
+    auto nanoseconds = std::chrono::duration<double, std::nano>(
+        endTime - startTime).count();
+    auto frequency =
+        static_cast<double>(endCounter - startCounter) / nanoseconds * 1e9;
+    if (!(frequency > 0)) {
+        return calibration;
+    }
+
+    calibration.tsc = true;
+    calibration.frequency = frequency;
+    calibration.baseCounter = endCounter;
+    calibration.baseTime = std::chrono::duration_cast<FastClock::duration>(
+        endTime.time_since_epoch()).count();
+    calibration.multiplier =
+        static_cast<uint64_t>(1e9 / frequency * 4294967296.0);
+    return calibration;
+}
+
+const Calibration& calibration() noexcept
+{
+    static const auto calibration = calibrate();
+    return calibration;
+}
+
+#endif
+
+} // namespace
+
+FastClock::time_point FastClock::now() noexcept
+{
+#ifdef TEMPO_FAST_CLOCK_TSC
+    const auto& c = calibration();
+    if (c.tsc) {
+        // Counters of other cores may be a little behind the base
+        auto elapsed = static_cast<int64_t>(__rdtsc() - c.baseCounter);
+        auto nanoseconds = static_cast<rep>(
+            (static_cast<Wide>(elapsed) * c.multiplier) >> 32U);
+        return time_point{duration{c.baseTime + nanoseconds}};
+    }
+#endif
+    return time_point{duration{steadyNow()}};
+}
+
+bool FastClock::usesTsc() noexcept
+{
+#ifdef TEMPO_FAST_CLOCK_TSC
+    return calibration().tsc;
+#else
+    return false;
+#endif
+}
+
+double FastClock::tscFrequency() noexcept
+{
+#ifdef TEMPO_FAST_CLOCK_TSC
+    return calibration().frequency;
+#else
+    return 0.0;
+#endif
+}
+
+FastClock::time_point FastClock::frameNow() noexcept
+{
+    return time_point{duration{frameTime.load(std::memory_order_relaxed)}};
+}
+
+FastClock::time_point FastClock::updateFrameNow() noexcept
+{
+    auto time = now();
+    frameTime.store(
+        time.time_since_epoch().count(), std::memory_order_relaxed);
+    return time;
+}
+
+} // namespace tempo
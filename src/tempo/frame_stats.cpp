@@ -0,0 +1,153 @@
+#include <tempo/frame_stats.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace tempo {
+
+FrameStats::FrameStats(Duration hitchThreshold, size_t window)
+    : _hitchThreshold(hitchThreshold)
+    , _frames(window)
+{
+    if (window == 0) {
+        throw std::invalid_argument{"tempo::FrameStats: window is empty"};
+    }
+}
+
+void FrameStats::add(Duration frameTime)
+{
+    if (_size == _frames.size()) {
+        auto oldest = _frames[_next];
+        _buckets[bucket(oldest)]--;
+        _sum -= oldest;
+        if (oldest > _hitchThreshold) {
+            _windowHitches--;
+        }
+    } else {
+        _size++;
+    }
+
+    _frames[_next] = frameTime;
+    _next = (_next + 1) % _frames.size();
+    _buckets[bucket(frameTime)]++;
+    _sum += frameTime;
+    _totalFrames++;
+    if (frameTime > _hitchThreshold) {
+        _windowHitches++;
+        _totalHitches++;
+    }
+}
+
+void FrameStats::reset()
+{
+    _next = 0;
+    _size = 0;
+    _sum = {};
+    _buckets = {};
+    _windowHitches = 0;
+    _totalHitches = 0;
+    _totalFrames = 0;
+}
+
+size_t FrameStats::size() const
+{
+    return _size;
+}
+
+size_t FrameStats::window() const
+{
+    return _frames.size();
+}
+
+FrameStats::Duration FrameStats::hitchThreshold() const
+{
+    return _hitchThreshold;
+}
+
+FrameStats::Duration FrameStats::percentile(double p) const
+{
+    if (_size == 0) {
+        return {};
+    }
+
+    auto fraction = std::clamp(p, 0.0, 100.0) / 100.0;
+    auto rank = std::max<size_t>(1, static_cast<size_t>(
+        std::ceil(fraction * static_cast<double>(_size))));
+
+    size_t seen = 0;
+    for (size_t i = 0; i < bucketCount; i++) {
+        seen += _buckets[i];
+        if (seen >= rank) {
+            return Duration{bucketWidth} * (i + 1);
+        }
+    }
+    return Duration{bucketWidth} * bucketCount;
+}
+
+FrameStats::Duration FrameStats::p50() const
+{
+    return percentile(50);
+}
+
+FrameStats::Duration FrameStats::p95() const
+{
+    return percentile(95);
+}
+
+FrameStats::Duration FrameStats::p99() const
+{
+    return percentile(99);
+}
+
+FrameStats::Duration FrameStats::mean() const
+{
+    return _size == 0 ? Duration{} :
+        _sum / static_cast<Duration::rep>(_size);
+}
+
+FrameStats::Duration FrameStats::last() const
+{
+    return _size == 0 ? Duration{} :
+        _frames[(_next + _frames.size() - 1) % _frames.size()];
+}
+
+size_t FrameStats::windowHitches() const
+{
+    return _windowHitches;
+}
+
+uint64_t FrameStats::totalHitches() const
+{
+    return _totalHitches;
+}
+
+uint64_t FrameStats::totalFrames() const
+{
+    return _totalFrames;
+}
+
+size_t FrameStats::bucket(Duration frameTime)
+{
+    // Bucket i holds frame times in (i, i + 1] bucket widths, so that a
+    // frame time on a boundary is not rounded up a whole bucket
+    auto width = Duration{bucketWidth};
+    auto index = std::max<Duration::rep>(
+        (frameTime + width - Duration{1}) / width - 1, 0);
+    return std::min(static_cast<size_t>(index), bucketCount - 1);
+}
+
+std::ostream& operator<<(std::ostream& output, const FrameStats& stats)
+{
+    auto ms = [] (FrameStats::Duration duration) {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    };
+    return output <<
+        "p50 " << ms(stats.p50()) << " ms, " <<
+        "p95 " << ms(stats.p95()) << " ms, " <<
+        "p99 " << ms(stats.p99()) << " ms, " <<
+        "mean " << ms(stats.mean()) << " ms, " <<
+        stats.windowHitches() << " hitches in " << stats.size() << " frames";
+}
+
+} // namespace tempo
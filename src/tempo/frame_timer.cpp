@@ -1,35 +1,192 @@
 #include <tempo/frame_timer.hpp>
 
+#include <algorithm>
+#include <cerrno>
 #include <thread>
 
+#ifdef __linux__
+#include <sys/timerfd.h>
+#include <unistd.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
 namespace tempo {
 
-FrameTimer::FrameTimer(int fps)
+namespace {
+
+// Tell the CPU that this is a spin loop
+void spinPause()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+} // namespace
+
+FrameTimer::Clock::duration FrameTimer::PacingStats::meanOversleep() const
+{
+    return sleeps == 0 ? Clock::duration{} :
+        totalOversleep / static_cast<Clock::rep>(sleeps);
+}
+
+void FrameTimer::PacingStats::addSleep(Clock::duration oversleep)
+{
+    sleeps++;
+    lastOversleep = oversleep;
+    maxOversleep = std::max(maxOversleep, oversleep);
+    totalOversleep += oversleep;
+
+    // Keep the margin a little above the oversleep seen lately, letting it
+    // shrink slowly after a late wake-up
+    auto adapted = std::max<Clock::duration>(
+        oversleep + oversleep / 4, margin - margin / 64);
+    margin = std::clamp<Clock::duration>(adapted, minMargin, maxMargin);
+}
+
+FrameTimer::FrameTimer(int fps, Pacing pacing, Waiter waiter)
     : _delta(1.0 / fps)
     , _lastFrame(0)
     , _startTime(Clock::now())
     , _frameDuration(std::chrono::duration_cast<Clock::duration>(
         std::chrono::duration<double>(_delta)))
-{ }
+    , _lastFrameTime(_startTime)
+    , _frameStats(2 * _frameDuration)
+    , _pacing(pacing)
+    , _waiter(Waiter::Thread)
+{
+#ifdef __linux__
+    if (waiter == Waiter::TimerFd) {
+        _timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+        if (_timerFd >= 0) {
+            _waiter = Waiter::TimerFd;
+        }
+    }
+#endif
+    _stats.margin = initialMargin;
+}
+
+FrameTimer::~FrameTimer()
+{
+#ifdef __linux__
+    if (_timerFd >= 0) {
+        close(_timerFd);
+    }
+#endif
+}
 
 double FrameTimer::delta() const
 {
     return _delta;
 }
 
+Pacing FrameTimer::pacing() const
+{
+    return _pacing;
+}
+
+Waiter FrameTimer::waiter() const
+{
+    return _waiter;
+}
+
+const FrameTimer::PacingStats& FrameTimer::stats() const
+{
+    return _stats;
+}
+
+void FrameTimer::resetStats()
+{
+    auto margin = _stats.margin;
+    _stats = PacingStats{};
+    _stats.margin = margin;
+}
+
+const FrameStats& FrameTimer::frameStats() const
+{
+    return _frameStats;
+}
+
+FrameStats& FrameTimer::frameStats()
+{
+    return _frameStats;
+}
+
 int FrameTimer::operator()()
 {
-    auto currentTime = Clock::now();
+    auto currentTime = Clock::updateFrameNow();
     auto currentFrame = (currentTime - _startTime) / _frameDuration;
     auto frameDiff = currentFrame - _lastFrame;
     _lastFrame = currentFrame;
+
+    if (frameDiff > 0) {
+        _frameStats.add(currentTime - _lastFrameTime);
+        _lastFrameTime = currentTime;
+    }
     return static_cast<int>(frameDiff);
 }
 
-void FrameTimer::relax() const
+void FrameTimer::relax()
 {
     auto nextFrameTime = _startTime + (_lastFrame + 1) * _frameDuration;
-    std::this_thread::sleep_until(nextFrameTime);
+
+    if (_pacing == Pacing::Sleep) {
+        sleepUntil(nextFrameTime);
+    } else {
+        sleepUntil(nextFrameTime - _stats.margin);
+        while (Clock::now() < nextFrameTime) {
+            spinPause();
+        }
+    }
+
+    auto lateness = std::max<Clock::duration>(
+        Clock::now() - nextFrameTime, Clock::duration{});
+    _stats.frames++;
+    _stats.lastLateness = lateness;
+    _stats.maxLateness = std::max(_stats.maxLateness, lateness);
+}
+
+void FrameTimer::sleepUntil(Clock::time_point time)
+{
+    auto start = Clock::now();
+    if (start >= time) {
+        return;
+    }
+
+#ifdef __linux__
+    if (_timerFd >= 0) {
+        auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            time - start);
+        auto spec = itimerspec{};
+        auto seconds =
+            std::chrono::duration_cast<std::chrono::seconds>(duration);
+        spec.it_value.tv_sec = static_cast<time_t>(seconds.count());
+        spec.it_value.tv_nsec =
+            static_cast<long>((duration - seconds).count());
+        if (spec.it_value.tv_sec == 0 && spec.it_value.tv_nsec == 0) {
+            spec.it_value.tv_nsec = 1;
+        }
+
+        if (timerfd_settime(_timerFd, 0, &spec, nullptr) == 0) {
+            uint64_t expirations = 0;
+            while (read(_timerFd, &expirations, sizeof(expirations)) < 0 &&
+                    errno == EINTR) {
+            }
+        }
+    } else {
+        std::this_thread::sleep_until(time);
+    }
+#else
+    std::this_thread::sleep_until(time);
+#endif
+
+    _stats.addSleep(
+        std::max<Clock::duration>(Clock::now() - time, Clock::duration{}));
 }
 
 } // namespace tempo
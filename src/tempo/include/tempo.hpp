@@ -1,4 +1,9 @@
 #pragma once
 
+#include <tempo/fast_clock.hpp>
+#include <tempo/frame_stats.hpp>
 #include <tempo/frame_timer.hpp>
+#include <tempo/loop.hpp>
 #include <tempo/metronome.hpp>
+#include <tempo/profiler.hpp>
+#include <tempo/timer_wheel.hpp>
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+
+namespace tempo {
+
+/**
+ * Write a string as a JSON string literal. Quotes, backslashes and control
+ * characters are escaped; other bytes are written as they are.
+ */
+void writeJsonString(std::ostream& output, std::string_view string);
+
+/**
+ * Writes spans of time as complete events of the Chrome trace event format,
+ * the JSON that chrome://tracing and Perfetto open. The trace is closed when
+ * the writer is destroyed.
+ */
+class ChromeTraceWriter {
+public:
+    using Microseconds = std::chrono::duration<double, std::micro>;
+
+    struct Event {
+        std::string_view name;
+        uint32_t thread = 0;
+        // From the start of the trace
+        Microseconds start {};
+        Microseconds duration {};
+        // Shown with the event, unless the key is empty
+        std::string_view argumentKey;
+        std::string_view argumentValue;
+    };
+
+    ChromeTraceWriter(std::ostream& output, std::string_view category);
+
+    ChromeTraceWriter(const ChromeTraceWriter&) = delete;
+    ChromeTraceWriter(ChromeTraceWriter&&) = delete;
+    ChromeTraceWriter& operator=(const ChromeTraceWriter&) = delete;
+    ChromeTraceWriter& operator=(ChromeTraceWriter&&) = delete;
+
+    ~ChromeTraceWriter();
+
+    void write(const Event& event);
+
+private:
+    std::ostream& _output;
+    std::string_view _category;
+    bool _first = true;
+};
+
+} // namespace tempo
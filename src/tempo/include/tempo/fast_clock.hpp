@@ -0,0 +1,47 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace tempo {
+
+/**
+ * Monotonic clock for tight loops. On x86-64 with an invariant time stamp
+ * counter, now() reads the counter and scales it, which is several times
+ * cheaper than a system call or even the vDSO. The counter is calibrated
+ * against steady_clock on first use, which takes about 10 ms. Elsewhere the
+ * clock falls back to steady_clock, which is CLOCK_MONOTONIC on Linux.
+ *
+ * Time points share the epoch of steady_clock, give or take the calibration
+ * error of a few microseconds per second.
+ *
+ * Code that only needs the time of the current frame can read frameNow(),
+ * which the frame loop updates once per frame; see Loop and FrameTimer.
+ */
+class FastClock {
+public:
+    using rep = int64_t;
+    using period = std::nano;
+    using duration = std::chrono::duration<rep, period>;
+    using time_point = std::chrono::time_point<FastClock>;
+    static constexpr bool is_steady = true;
+
+    static time_point now() noexcept;
+
+    /** True if now() reads the time stamp counter. */
+    [[nodiscard]] static bool usesTsc() noexcept;
+
+    /** Measured counter ticks per second, or 0 without the counter. */
+    [[nodiscard]] static double tscFrequency() noexcept;
+
+    /**
+     * Time of the last updateFrameNow() call, from any thread; the epoch
+     * before the first one.
+     */
+    static time_point frameNow() noexcept;
+
+    /** Set frameNow() to now(), and return it. */
+    static time_point updateFrameNow() noexcept;
+};
+
+} // namespace tempo
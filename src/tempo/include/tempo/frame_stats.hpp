@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace tempo {
+
+/**
+ * Frame times of the last frames, with rolling percentiles. Frame times are
+ * counted in a histogram of fixed-width buckets as they enter and leave the
+ * window, so that adding a frame takes constant time, and a percentile is a
+ * walk over the buckets. Percentiles are rounded up to the bucket width;
+ * frames longer than the last bucket are counted there.
+ *
+ * Frames longer than the hitch threshold are counted as hitches.
+ */
+class FrameStats {
+public:
+    using Duration = std::chrono::nanoseconds;
+
+    static constexpr size_t defaultWindow = 600;
+    static constexpr auto bucketWidth = std::chrono::microseconds{50};
+    static constexpr size_t bucketCount = 1000;
+
+    explicit FrameStats(Duration hitchThreshold, size_t window = defaultWindow);
+
+    void add(Duration frameTime);
+    void reset();
+
+    /** Number of frames in the window. */
+    [[nodiscard]] size_t size() const;
+    [[nodiscard]] size_t window() const;
+    [[nodiscard]] Duration hitchThreshold() const;
+
+    /** Frame time that p percent of the frames in the window do not exceed. */
+    [[nodiscard]] Duration percentile(double p) const;
+    [[nodiscard]] Duration p50() const;
+    [[nodiscard]] Duration p95() const;
+    [[nodiscard]] Duration p99() const;
+
+    [[nodiscard]] Duration mean() const;
+    [[nodiscard]] Duration last() const;
+
+    /** Hitches in the window, and since construction or reset(). */
+    [[nodiscard]] size_t windowHitches() const;
+    [[nodiscard]] uint64_t totalHitches() const;
+    [[nodiscard]] uint64_t totalFrames() const;
+
+private:
+    static size_t bucket(Duration frameTime);
+
+    Duration _hitchThreshold;
+    std::vector<Duration> _frames;
+    size_t _next = 0;
+    size_t _size = 0;
+    Duration _sum {};
+
+    std::array<uint32_t, bucketCount> _buckets {};
+    size_t _windowHitches = 0;
+    uint64_t _totalHitches = 0;
+    uint64_t _totalFrames = 0;
+};
+
+/** One-line summary for logs, in milliseconds. */
+std::ostream& operator<<(std::ostream& output, const FrameStats& stats);
+
+} // namespace tempo
@@ -1,23 +1,111 @@
 #pragma once
 
+#include <tempo/fast_clock.hpp>
+#include <tempo/frame_stats.hpp>
+
 #include <chrono>
+#include <cstdint>
 
 namespace tempo {
 
+/** How FrameTimer::relax() waits for the next frame. */
+enum class Pacing : uint8_t {
+    // Sleep until the frame. The thread may wake up late, by up to a
+    // millisecond depending on the system's timer slack.
+    Sleep,
+
+    // Sleep until a margin before the frame, then spin until it. The margin
+    // follows the measured oversleep.
+    Hybrid,
+};
+
+/** What FrameTimer::relax() sleeps with. */
+enum class Waiter : uint8_t {
+    Thread,
+
+    // A timerfd, on Linux; falls back to Thread elsewhere
+    TimerFd,
+};
+
 class FrameTimer {
 public:
-    explicit FrameTimer(int fps);
+    using Clock = FastClock;
+
+    /** Bounds and initial value of the margin of Pacing::Hybrid. */
+    static constexpr auto minMargin = std::chrono::microseconds{50};
+    static constexpr auto maxMargin = std::chrono::microseconds{2000};
+    static constexpr auto initialMargin = std::chrono::microseconds{500};
+
+    /** How late sleeping in relax() wakes up, and how late it returns. */
+    struct PacingStats {
+        [[nodiscard]] Clock::duration meanOversleep() const;
+
+        /**
+         * Count a sleep that woke up oversleep late, and adapt the margin:
+         * it grows at once to a little above the oversleep, and shrinks by
+         * 1/64 per sleep, within minMargin and maxMargin.
+         */
+        void addSleep(Clock::duration oversleep);
+
+        uint64_t sleeps = 0;
+        Clock::duration lastOversleep {};
+        Clock::duration maxOversleep {};
+        Clock::duration totalOversleep {};
+
+        uint64_t frames = 0;
+        Clock::duration lastLateness {};
+        Clock::duration maxLateness {};
+
+        Clock::duration margin {};
+    };
+
+    explicit FrameTimer(
+        int fps, Pacing pacing = Pacing::Sleep, Waiter waiter = Waiter::Thread);
+
+    // A timerfd is owned
+    FrameTimer(const FrameTimer&) = delete;
+    FrameTimer(FrameTimer&&) = delete;
+    FrameTimer& operator=(const FrameTimer&) = delete;
+    FrameTimer& operator=(FrameTimer&&) = delete;
+
+    ~FrameTimer();
+
     [[nodiscard]] double delta() const;
+    [[nodiscard]] Pacing pacing() const;
+
+    /** Waiter in use, which may differ from the requested one. */
+    [[nodiscard]] Waiter waiter() const;
+
+    [[nodiscard]] const PacingStats& stats() const;
+    void resetStats();
+
+    /**
+     * Times between calls that started new frames. Frames longer than two
+     * frame durations are hitches.
+     */
+    [[nodiscard]] const FrameStats& frameStats() const;
+    FrameStats& frameStats();
+
+    /** Number of frames since the last call. Updates FastClock::frameNow(). */
     int operator()();
-    void relax() const;
+
+    /** Wait until the next frame. */
+    void relax();
 
 private:
-    using Clock = std::chrono::high_resolution_clock;
+    void sleepUntil(Clock::time_point time);
 
     const double _delta;
     long long _lastFrame;
     Clock::time_point _startTime;
     Clock::duration _frameDuration;
+    Clock::time_point _lastFrameTime;
+    FrameStats _frameStats;
+
+    Pacing _pacing;
+    Waiter _waiter;
+    int _timerFd = -1;
+    PacingStats _stats;
 };
 
 } // namespace tempo
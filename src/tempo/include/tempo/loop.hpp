@@ -0,0 +1,81 @@
+#pragma once
+
+#include <tempo/fast_clock.hpp>
+
+#include <chrono>
+#include <cstdint>
+
+namespace tempo {
+
+/**
+ * Fixed-timestep game loop. Simulation is advanced in steps of the same
+ * duration, as many as real time calls for, and rendering gets the fraction
+ * of a step that has passed since the last one, to interpolate between the
+ * last two simulation states.
+ *
+ * When a frame falls behind by more than maxCatchUp steps, the extra time is
+ * dropped instead of being simulated, so a slow update cannot keep the loop
+ * catching up forever.
+ */
+class Loop {
+public:
+    static constexpr int defaultMaxCatchUp = 5;
+
+    explicit Loop(int updatesPerSecond, int maxCatchUp = defaultMaxCatchUp);
+
+    /** Duration of a simulation step, in seconds. */
+    [[nodiscard]] double delta() const;
+
+    /** Real time between the last two frames, in seconds. */
+    [[nodiscard]] double frameTime() const;
+
+    /** Fraction of a step accumulated since the last update, in [0, 1). */
+    [[nodiscard]] double alpha() const;
+
+    /** Steps dropped so far because the loop fell too far behind. */
+    [[nodiscard]] uint64_t droppedSteps() const;
+
+    /**
+     * Measure the time since the previous frame, or since construction or
+     * reset(), and return the number of steps to simulate now. Updates
+     * FastClock::frameNow().
+     */
+    int advance();
+
+    /**
+     * Same as advance(), with the time of this frame given by the caller,
+     * who keeps it monotonic; FastClock::frameNow() is left alone.
+     */
+    int advance(FastClock::time_point now);
+
+    /**
+     * Run one frame: call update(delta()) for each due step, then
+     * render(alpha()).
+     */
+    template <class Update, class Render>
+    void frame(Update&& update, Render&& render)
+    {
+        for (int steps = advance(); steps > 0; steps--) {
+            update(delta());
+        }
+        render(alpha());
+    }
+
+    /** Start measuring from now, dropping accumulated time. */
+    void reset();
+    void reset(FastClock::time_point now);
+
+private:
+    using Clock = FastClock;
+
+    const double _delta;
+    const Clock::duration _step;
+    const int _maxCatchUp;
+
+    Clock::time_point _lastFrame;
+    Clock::duration _accumulated {};
+    Clock::duration _frameTime {};
+    uint64_t _droppedSteps = 0;
+};
+
+} // namespace tempo
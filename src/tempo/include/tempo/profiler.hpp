@@ -0,0 +1,197 @@
+#pragma once
+
+#include <tempo/fast_clock.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+namespace tempo {
+
+namespace internals {
+
+// Ring of finished scopes of one thread. The thread is the only writer, and
+// Profiler::frame() the only reader, so neither takes a lock. Scopes that do
+// not fit are dropped.
+class ScopeRing {
+public:
+    using Clock = FastClock;
+
+    struct Event {
+        const char* name = nullptr;
+        Clock::time_point start;
+        Clock::time_point end;
+        uint32_t depth = 0;
+    };
+
+    ScopeRing(uint32_t thread, size_t size);
+
+    void push(const Event& event);
+    void drain(std::vector<Event>& events);
+
+    [[nodiscard]] uint32_t thread() const;
+    [[nodiscard]] uint64_t dropped() const;
+
+    // Set when the thread exits; the ring is removed once drained
+    void retire();
+    [[nodiscard]] bool retired() const;
+
+private:
+    const uint32_t _thread;
+    std::vector<Event> _events;
+    std::atomic<uint64_t> _write = 0;
+    std::atomic<uint64_t> _read = 0;
+    std::atomic<uint64_t> _dropped = 0;
+    std::atomic<bool> _retired = false;
+};
+
+// Ring of the calling thread, created on first use
+ScopeRing& threadRing();
+
+// Nesting depth of open scopes in the calling thread
+inline thread_local uint32_t scopeDepth = 0;
+
+inline std::atomic<bool> profilingEnabled = false;
+
+} // namespace internals
+
+/**
+ * Collects scopes marked with TEMPO_SCOPE in all threads. Scopes are recorded
+ * only while profiling is enabled. Each call to frame() gathers the scopes
+ * that have finished since the previous one into a tree per thread, with
+ * scopes of the same name under the same parent added up, and keeps them for
+ * the Chrome trace.
+ */
+class Profiler {
+public:
+    using Clock = internals::ScopeRing::Clock;
+
+    static constexpr size_t defaultRingSize = size_t{1} << 14;
+
+    struct Node {
+        [[nodiscard]] Clock::duration self() const;
+
+        std::string_view name;
+        uint64_t calls = 0;
+        Clock::duration total {};
+        Clock::duration childTotal {};
+        std::vector<size_t> children;
+    };
+
+    /** Scopes of one thread in a frame. Node 0 is the root, with no name. */
+    struct ThreadTree {
+        uint32_t thread = 0;
+        std::vector<Node> nodes;
+    };
+
+    static Profiler& instance();
+
+    static void enable(bool enabled = true);
+    [[nodiscard]] static bool enabled();
+
+    /** End a frame, and gather its scopes. */
+    void frame();
+
+    [[nodiscard]] const std::vector<ThreadTree>& lastFrame() const;
+
+    /** Scopes dropped because a thread's ring was full. */
+    [[nodiscard]] uint64_t dropped() const;
+
+    /**
+     * Limit the number of scopes kept for the Chrome trace. Frame trees are
+     * not affected by the limit.
+     */
+    void traceLimit(size_t limit);
+
+    void reset();
+
+    /** Write the trees of the last frame, one scope per line. */
+    void writeFrame(std::ostream& output) const;
+
+    /**
+     * Write the kept scopes as a Chrome trace, one event per scope, on a
+     * track for each thread that recorded scopes.
+     */
+    void writeChromeTrace(std::ostream& output) const;
+
+    // Called once by each thread that records a scope
+    std::shared_ptr<internals::ScopeRing> addThread();
+
+private:
+    struct TraceEvent {
+        const char* name = nullptr;
+        uint32_t thread = 0;
+        Clock::time_point start;
+        Clock::duration duration {};
+    };
+
+    Profiler() = default;
+
+    void gather(
+        uint32_t thread, std::vector<internals::ScopeRing::Event>& events);
+
+    mutable std::mutex _threadMutex;
+    std::vector<std::shared_ptr<internals::ScopeRing>> _rings;
+    uint32_t _nextThread = 0;
+    uint64_t _retiredDropped = 0;
+
+    std::vector<internals::ScopeRing::Event> _events;
+    std::vector<ThreadTree> _lastFrame;
+    std::vector<TraceEvent> _trace;
+    size_t _traceLimit = size_t{1} << 16;
+    Clock::time_point _start = Clock::now();
+};
+
+/** Marks a scope for the profiler; see TEMPO_SCOPE. */
+class Scope {
+public:
+    explicit Scope(const char* name)
+    {
+        if (internals::profilingEnabled.load(std::memory_order_relaxed)) {
+            _name = name;
+            _depth = internals::scopeDepth++;
+            _start = Profiler::Clock::now();
+        }
+    }
+
+    Scope(const Scope&) = delete;
+    Scope(Scope&&) = delete;
+    Scope& operator=(const Scope&) = delete;
+    Scope& operator=(Scope&&) = delete;
+
+    ~Scope()
+    {
+        if (_name) {
+            internals::scopeDepth--;
+            internals::threadRing().push({
+                .name = _name,
+                .start = _start,
+                .end = Profiler::Clock::now(),
+                .depth = _depth,
+            });
+        }
+    }
+
+private:
+    const char* _name = nullptr;
+    uint32_t _depth = 0;
+    Profiler::Clock::time_point _start;
+};
+
+} // namespace tempo
+
+#define TEMPO_INTERNALS_CONCAT_(a, b) a##b
+#define TEMPO_INTERNALS_CONCAT(a, b) TEMPO_INTERNALS_CONCAT_(a, b)
+
+/**
+ * Profile the rest of the enclosing scope under the given name, which must be
+ * a string literal.
+ */
+#define TEMPO_SCOPE(name) \
+    ::tempo::Scope TEMPO_INTERNALS_CONCAT(tempoScope, __LINE__) {name}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace tempo {
+
+/** Handle of a timer in a TimerWheel. Stays invalid after the timer is gone. */
+struct TimerId {
+    uint32_t index = 0;
+    uint32_t generation = 0;
+
+    friend bool operator==(const TimerId&, const TimerId&) = default;
+};
+
+/**
+ * Schedules many one-shot and periodic callbacks on a hierarchical timing
+ * wheel. Time is counted in ticks of a fixed resolution; four levels of 256
+ * slots hold timers due within 256, 2^16, 2^24 and 2^32 ticks. Adding and
+ * cancelling a timer take constant time, and advancing only touches timers
+ * that are due, besides moving timers down a level once per slot of the
+ * level above.
+ *
+ * Periodic timers are due at multiples of their period, counted in fixed
+ * point to 1/2^32 of a tick and rounded up to a tick, so they do not drift.
+ * A timer that is due several times in one tick is called several times.
+ * Ticks with nothing due are skipped in bulk.
+ */
+class TimerWheel {
+public:
+    using Callback = std::function<void()>;
+
+    static constexpr double defaultResolution = 0.001;
+
+    explicit TimerWheel(double resolution = defaultResolution);
+
+    /** Call callback once, after delay seconds. */
+    TimerId after(double delay, Callback callback);
+
+    /** Call callback every period seconds, starting a period from now. */
+    TimerId every(double period, Callback callback);
+
+    /** Remove a timer. Returns false if it has already fired or is gone. */
+    bool cancel(TimerId id);
+
+    [[nodiscard]] bool contains(TimerId id) const;
+
+    /** Advance time by delta seconds, and call the timers that are due. */
+    void advance(double delta);
+
+    [[nodiscard]] double now() const;
+    [[nodiscard]] double resolution() const;
+    [[nodiscard]] size_t size() const;
+    [[nodiscard]] bool empty() const;
+
+    void clear();
+
+private:
+    static constexpr size_t levelCount = 4;
+    static constexpr size_t slotBits = 8;
+    static constexpr size_t slotCount = size_t{1} << slotBits;
+    static constexpr uint32_t none = UINT32_MAX;
+
+    // Lists are doubly linked through the timers. The last list holds the
+    // timers being fired in the current tick.
+    static constexpr size_t firingList = levelCount * slotCount;
+
+    // Time in ticks, with 32 bits of fraction. Periods are added to due
+    // times exactly, so rounding does not build up.
+    struct Ticks {
+        uint64_t whole = 0;
+        uint32_t fraction = 0;
+    };
+
+    struct Timer {
+        Callback callback;
+        Ticks due;
+        Ticks period;
+        uint64_t expiry = 0;
+        uint32_t generation = 0;
+        uint32_t list = none;
+        uint32_t prev = none;
+        uint32_t next = none;
+    };
+
+    static bool isPeriodic(const Timer& timer);
+    static Ticks addTicks(Ticks lhs, Ticks rhs);
+    static uint64_t expiryTick(Ticks due);
+
+    TimerId add(double due, double period, Callback callback);
+    [[nodiscard]] Ticks toTicks(double seconds) const;
+
+    void skipIdleTicks(uint64_t end);
+    void place(uint32_t index);
+    void link(uint32_t index, size_t list);
+    void unlink(uint32_t index);
+    void release(uint32_t index);
+
+    void cascade(size_t level);
+    void fire();
+
+    double _resolution;
+    double _remainder = 0.0;
+    uint64_t _now = 0;
+    size_t _size = 0;
+
+    std::vector<Timer> _timers;
+    std::vector<uint32_t> _free;
+    std::array<uint32_t, levelCount * slotCount + 1> _lists;
+
+    // Timers per level, and in the list being fired
+    std::array<size_t, levelCount + 1> _levelSizes {};
+};
+
+} // namespace tempo
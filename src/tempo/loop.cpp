@@ -0,0 +1,81 @@
+#include <tempo/loop.hpp>
+
+#include <stdexcept>
+
+namespace tempo {
+
+namespace {
+
+int positive(int value)
+{
+    if (value <= 0) {
+        throw std::invalid_argument{
+            "tempo::Loop: update rate and catch-up limit must be positive"};
+    }
+    return value;
+}
+
+} // namespace
+
+Loop::Loop(int updatesPerSecond, int maxCatchUp)
+    : _delta(1.0 / positive(updatesPerSecond))
+    , _step(std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(_delta)))
+    , _maxCatchUp(positive(maxCatchUp))
+    , _lastFrame(Clock::now())
+{ }
+
+double Loop::delta() const
+{
+    return _delta;
+}
+
+double Loop::frameTime() const
+{
+    return std::chrono::duration<double>(_frameTime).count();
+}
+
+double Loop::alpha() const
+{
+    return std::chrono::duration<double>(_accumulated) /
+        std::chrono::duration<double>(_step);
+}
+
+uint64_t Loop::droppedSteps() const
+{
+    return _droppedSteps;
+}
+
+int Loop::advance()
+{
+    return advance(Clock::updateFrameNow());
+}
+
+int Loop::advance(Clock::time_point now)
+{
+    _frameTime = now - _lastFrame;
+    _lastFrame = now;
+    _accumulated += _frameTime;
+
+    auto steps = _accumulated / _step;
+    _accumulated -= steps * _step;
+    if (steps > _maxCatchUp) {
+        _droppedSteps += static_cast<uint64_t>(steps - _maxCatchUp);
+        steps = _maxCatchUp;
+    }
+    return static_cast<int>(steps);
+}
+
+void Loop::reset()
+{
+    reset(Clock::now());
+}
+
+void Loop::reset(Clock::time_point now)
+{
+    _lastFrame = now;
+    _accumulated = {};
+    _frameTime = {};
+}
+
+} // namespace tempo
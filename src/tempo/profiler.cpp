@@ -0,0 +1,285 @@
+#include <tempo/profiler.hpp>
+
+#include <tempo/chrome_trace.hpp>
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+namespace tempo {
+
+namespace {
+
+double microseconds(Profiler::Clock::duration duration)
+{
+    return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+void writeNode(
+    std::ostream& output,
+    const Profiler::ThreadTree& tree,
+    size_t index,
+    size_t indent)
+{
+    const auto& node = tree.nodes.at(index);
+    if (index != 0) {
+        output << std::string(2 * indent, ' ') << node.name <<
+            ": " << node.calls << " calls, " <<
+            microseconds(node.total) << " us total, " <<
+            microseconds(node.self()) << " us self\n";
+        indent++;
+    }
+    for (size_t child : node.children) {
+        writeNode(output, tree, child, indent);
+    }
+}
+
+} // namespace
+
+namespace internals {
+
+ScopeRing::ScopeRing(uint32_t thread, size_t size)
+    : _thread(thread)
+    , _events(size)
+{ }
+
+void ScopeRing::push(const Event& event)
+{
+    auto write = _write.load(std::memory_order_relaxed);
+    if (write - _read.load(std::memory_order_acquire) == _events.size()) {
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    _events[write % _events.size()] = event;
+    _write.store(write + 1, std::memory_order_release);
+}
+
+void ScopeRing::drain(std::vector<Event>& events)
+{
+    auto read = _read.load(std::memory_order_relaxed);
+    auto write = _write.load(std::memory_order_acquire);
+    for (; read != write; read++) {
+        events.push_back(_events[read % _events.size()]);
+    }
+    _read.store(read, std::memory_order_release);
+}
+
+uint32_t ScopeRing::thread() const
+{
+    return _thread;
+}
+
+uint64_t ScopeRing::dropped() const
+{
+    return _dropped.load(std::memory_order_relaxed);
+}
+
+void ScopeRing::retire()
+{
+    _retired.store(true, std::memory_order_release);
+}
+
+bool ScopeRing::retired() const
+{
+    return _retired.load(std::memory_order_acquire);
+}
+
+ScopeRing& threadRing()
+{
+    struct Holder {
+        explicit Holder(std::shared_ptr<ScopeRing> ring)
+            : ring(std::move(ring))
+        { }
+
+        Holder(const Holder&) = delete;
+        Holder(Holder&&) = delete;
+        Holder& operator=(const Holder&) = delete;
+        Holder& operator=(Holder&&) = delete;
+
+        ~Holder()
+        {
+            ring->retire();
+        }
+
+        std::shared_ptr<ScopeRing> ring;
+    };
+
+    thread_local auto holder = Holder{Profiler::instance().addThread()};
+    return *holder.ring;
+}
+
+} // namespace internals
+
+Profiler::Clock::duration Profiler::Node::self() const
+{
+    return total - childTotal;
+}
+
+Profiler& Profiler::instance()
+{
+    static auto profiler = Profiler{};
+    return profiler;
+}
+
+void Profiler::enable(bool enabled)
+{
+    internals::profilingEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool Profiler::enabled()
+{
+    return internals::profilingEnabled.load(std::memory_order_relaxed);
+}
+
+void Profiler::frame()
+{
+    auto rings = std::vector<std::shared_ptr<internals::ScopeRing>>{};
+    {
+        auto lock = std::scoped_lock{_threadMutex};
+        rings = _rings;
+    }
+
+    // A ring retired before it is drained gets no more scopes after that
+    auto drained = std::vector<const internals::ScopeRing*>{};
+
+    _lastFrame.clear();
+    for (const auto& ring : rings) {
+        if (ring->retired()) {
+            drained.push_back(ring.get());
+        }
+
+        _events.clear();
+        ring->drain(_events);
+        if (!_events.empty()) {
+            gather(ring->thread(), _events);
+        }
+    }
+
+    if (!drained.empty()) {
+        auto lock = std::scoped_lock{_threadMutex};
+        std::erase_if(_rings, [this, &drained] (const auto& ring) {
+            if (std::ranges::find(drained, ring.get()) == drained.end()) {
+                return false;
+            }
+            _retiredDropped += ring->dropped();
+            return true;
+        });
+    }
+}
+
+const std::vector<Profiler::ThreadTree>& Profiler::lastFrame() const
+{
+    return _lastFrame;
+}
+
+uint64_t Profiler::dropped() const
+{
+    auto lock = std::scoped_lock{_threadMutex};
+    uint64_t dropped = _retiredDropped;
+    for (const auto& ring : _rings) {
+        dropped += ring->dropped();
+    }
+    return dropped;
+}
+
+void Profiler::traceLimit(size_t limit)
+{
+    _traceLimit = limit;
+}
+
+void Profiler::reset()
+{
+    frame();
+    _lastFrame.clear();
+    _trace.clear();
+    _start = Clock::now();
+}
+
+void Profiler::writeFrame(std::ostream& output) const
+{
+    for (const auto& tree : _lastFrame) {
+        output << "thread " << tree.thread << "\n";
+        writeNode(output, tree, 0, 1);
+    }
+}
+
+void Profiler::writeChromeTrace(std::ostream& output) const
+{
+    auto trace = ChromeTraceWriter{output, "tempo"};
+    for (const auto& event : _trace) {
+        trace.write(ChromeTraceWriter::Event{
+            .name = event.name,
+            .thread = event.thread,
+            .start = event.start - _start,
+            .duration = event.duration,
+        });
+    }
+}
+
+std::shared_ptr<internals::ScopeRing> Profiler::addThread()
+{
+    auto lock = std::scoped_lock{_threadMutex};
+    auto thread = _nextThread++;
+    _rings.push_back(
+        std::make_shared<internals::ScopeRing>(thread, defaultRingSize));
+    return _rings.back();
+}
+
+void Profiler::gather(
+    uint32_t thread, std::vector<internals::ScopeRing::Event>& events)
+{
+    // Scopes are pushed as they end, so children come before their parents.
+    // In order of start, each scope follows its parent.
+    std::ranges::sort(events, [] (const auto& lhs, const auto& rhs) {
+        return lhs.start != rhs.start ? lhs.start < rhs.start :
+            lhs.depth < rhs.depth;
+    });
+
+    auto& tree = _lastFrame.emplace_back(ThreadTree{.thread = thread});
+    tree.nodes.emplace_back();
+
+    // Path of nodes from the root to the last scope. Scopes whose parent
+    // started in an earlier frame go under the deepest node there is.
+    auto path = std::vector<size_t>{0};
+    for (const auto& event : events) {
+        path.resize(std::min<size_t>(path.size(), event.depth + 1));
+        auto parent = path.back();
+
+        auto name = std::string_view{event.name};
+        auto& siblings = tree.nodes.at(parent).children;
+        auto it = std::ranges::find_if(siblings, [&tree, name] (size_t i) {
+            return tree.nodes.at(i).name == name;
+        });
+
+        size_t index = 0;
+        if (it != siblings.end()) {
+            index = *it;
+        } else {
+            index = tree.nodes.size();
+            tree.nodes.at(parent).children.push_back(index);
+            tree.nodes.push_back(Node{.name = name});
+        }
+
+        auto duration = event.end - event.start;
+        auto& node = tree.nodes.at(index);
+        node.calls++;
+        node.total += duration;
+        tree.nodes.at(parent).childTotal += duration;
+        path.push_back(index);
+
+        if (_trace.size() < _traceLimit) {
+            _trace.push_back(TraceEvent{
+                .name = event.name,
+                .thread = thread,
+                .start = event.start,
+                .duration = duration,
+            });
+        }
+    }
+
+    auto& root = tree.nodes.front();
+    root.calls = 1;
+    root.total = root.childTotal;
+}
+
+} // namespace tempo
@@ -0,0 +1,69 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <tempo/chrome_trace.hpp>
+
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+std::string jsonString(std::string_view string)
+{
+    auto output = std::ostringstream{};
+    tempo::writeJsonString(output, string);
+    return output.str();
+}
+
+} // namespace
+
+TEST_CASE("JSON strings escape quotes, backslashes and control characters",
+    "[chrome-trace]")
+{
+    REQUIRE(jsonString("plain") == R"("plain")");
+    REQUIRE(jsonString(R"(say "hi" \ bye)") == R"("say \"hi\" \\ bye")");
+    REQUIRE(jsonString("a\nb\tc") == R"("a\u000ab\u0009c")");
+    REQUIRE(jsonString(std::string_view{"\0\x1f", 2}) == R"("\u0000\u001f")");
+    REQUIRE(jsonString("\x7f caf\xc3\xa9") == "\"\x7f caf\xc3\xa9\"");
+}
+
+TEST_CASE("Chrome traces hold one complete event per span", "[chrome-trace]")
+{
+    auto output = std::ostringstream{};
+    {
+        auto trace = tempo::ChromeTraceWriter{output, "test"};
+        trace.write(tempo::ChromeTraceWriter::Event{
+            .name = "first\n",
+            .thread = 2,
+            .start = 1500ns,
+            .duration = 2us,
+        });
+        trace.write(tempo::ChromeTraceWriter::Event{
+            .name = "second",
+            .start = 10us,
+            .duration = 250ns,
+            .argumentKey = "why",
+            .argumentValue = "yield",
+        });
+    }
+
+    REQUIRE(output.str() ==
+        R"({"traceEvents":[)"
+        R"({"name":"first\u000a","cat":"test","ph":"X","pid":0,"tid":2,)"
+        R"("ts":1.5,"dur":2},)"
+        R"({"name":"second","cat":"test","ph":"X","pid":0,"tid":0,)"
+        R"("ts":10,"dur":0.25,"args":{"why":"yield"}})"
+        R"(],"displayTimeUnit":"ns"})");
+}
+
+TEST_CASE("An empty Chrome trace is valid", "[chrome-trace]")
+{
+    auto output = std::ostringstream{};
+    {
+        auto trace = tempo::ChromeTraceWriter{output, "test"};
+    }
+    REQUIRE(output.str() == R"({"traceEvents":[],"displayTimeUnit":"ns"})");
+}
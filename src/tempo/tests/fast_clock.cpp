@@ -0,0 +1,92 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <tempo/fast_clock.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+using Clock = tempo::FastClock;
+using Steady = std::chrono::steady_clock;
+
+struct Sample {
+    Clock::time_point fast;
+    Steady::time_point steady;
+};
+
+// Both clocks read as close together as the thread allows: the read of
+// steady_clock that is tightest around a read of the fast clock
+Sample sample()
+{
+    auto best = Sample{};
+    auto bestGap = Steady::duration::max();
+    for (int i = 0; i < 100; i++) {
+        auto before = Steady::now();
+        auto fast = Clock::now();
+        auto after = Steady::now();
+        if (after - before < bestGap) {
+            bestGap = after - before;
+            best = {fast, before + (after - before) / 2};
+        }
+    }
+    return best;
+}
+
+int64_t nanoseconds(std::chrono::nanoseconds duration)
+{
+    return duration.count();
+}
+
+} // namespace
+
+TEST_CASE("The fast clock keeps the rate of steady_clock", "[fast-clock]")
+{
+    if (Clock::usesTsc()) {
+        REQUIRE(Clock::tscFrequency() > 1e8);
+        REQUIRE(Clock::tscFrequency() < 1e11);
+    } else {
+        REQUIRE(Clock::tscFrequency() == 0);
+    }
+
+    auto start = sample();
+    std::this_thread::sleep_for(200ms);
+    auto end = sample();
+
+    // The 32.32 multiplier carries the error of 10 ms of calibration, well
+    // under 0.1%, and each sample the gap between its reads
+    auto fast = nanoseconds(end.fast - start.fast);
+    auto steady = nanoseconds(end.steady - start.steady);
+    REQUIRE(steady >= 200'000'000);
+    auto error = fast > steady ? fast - steady : steady - fast;
+    REQUIRE(error < steady / 1000 + 20'000);
+}
+
+TEST_CASE("The fast clock shares the epoch of steady_clock", "[fast-clock]")
+{
+    auto now = sample();
+    auto offset = nanoseconds(now.fast.time_since_epoch()) -
+        nanoseconds(now.steady.time_since_epoch());
+    REQUIRE(offset < 1'000'000);
+    REQUIRE(offset > -1'000'000);
+}
+
+TEST_CASE("The fast clock does not go back", "[fast-clock]")
+{
+    auto last = Clock::now();
+    int backwards = 0;
+    for (int i = 0; i < 1'000'000; i++) {
+        auto now = Clock::now();
+        backwards += now < last ? 1 : 0;
+        last = now;
+    }
+    REQUIRE(backwards == 0);
+
+    auto frame = Clock::updateFrameNow();
+    REQUIRE(frame >= last);
+    REQUIRE(Clock::frameNow() == frame);
+    REQUIRE(Clock::now() >= frame);
+}
@@ -0,0 +1,139 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <tempo/frame_stats.hpp>
+
+#include <chrono>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+using namespace std::chrono_literals;
+
+TEST_CASE("Percentiles rank the frames in the window", "[frame-stats]")
+{
+    auto stats = tempo::FrameStats{100ms};
+    for (int i = 100; i >= 1; i--) {
+        stats.add(i * 100us);
+    }
+    REQUIRE(stats.size() == 100);
+
+    REQUIRE(stats.p50() == 5ms);
+    REQUIRE(stats.p95() == 9500us);
+    REQUIRE(stats.p99() == 9900us);
+    REQUIRE(stats.percentile(100) == 10ms);
+    REQUIRE(stats.percentile(0) == 100us);
+    REQUIRE(stats.percentile(50.5) == 5100us);
+
+    // Out of range percentiles are clamped
+    REQUIRE(stats.percentile(-5) == 100us);
+    REQUIRE(stats.percentile(150) == 10ms);
+
+    REQUIRE(stats.mean() == 5050us);
+    REQUIRE(stats.last() == 100us);
+}
+
+TEST_CASE("Percentiles are rounded up to the bucket width", "[frame-stats]")
+{
+    REQUIRE(tempo::FrameStats::bucketWidth == 50us);
+
+    auto percentileOf = [] (tempo::FrameStats::Duration frameTime) {
+        auto stats = tempo::FrameStats{100ms};
+        stats.add(frameTime);
+        return stats.p50();
+    };
+    REQUIRE(percentileOf(1ns) == 50us);
+    REQUIRE(percentileOf(50us) == 50us);
+    REQUIRE(percentileOf(50us + 1ns) == 100us);
+    REQUIRE(percentileOf(120us) == 150us);
+    REQUIRE(percentileOf(16'666'667ns) == 16'700us);
+    REQUIRE(percentileOf(0ns) == 50us);
+    REQUIRE(percentileOf(-1ms) == 50us);
+}
+
+TEST_CASE("Percentiles stop at 50 ms", "[frame-stats]")
+{
+    REQUIRE(
+        tempo::FrameStats::bucketWidth * tempo::FrameStats::bucketCount ==
+        50ms);
+
+    auto stats = tempo::FrameStats{100ms};
+    stats.add(49'950us + 1ns);
+    REQUIRE(stats.p50() == 50ms);
+
+    // Longer frames are counted in the last bucket, but not in the mean
+    stats.add(50ms);
+    stats.add(200ms);
+    stats.add(10s);
+    REQUIRE(stats.p99() == 50ms);
+    REQUIRE(stats.percentile(25) == 50ms);
+    REQUIRE(stats.mean() == (49'950us + 1ns + 50ms + 200ms + 10s) / 4);
+    REQUIRE(stats.last() == 10s);
+}
+
+TEST_CASE("Frames leave the window in order", "[frame-stats]")
+{
+    auto stats = tempo::FrameStats{100ms, 4};
+    REQUIRE(stats.window() == 4);
+    for (int i = 0; i < 4; i++) {
+        stats.add(10ms);
+    }
+    REQUIRE(stats.p50() == 10ms);
+
+    stats.add(1ms);
+    stats.add(1ms);
+    REQUIRE(stats.size() == 4);
+    REQUIRE(stats.p50() == 1ms);
+    REQUIRE(stats.p99() == 10ms);
+    REQUIRE(stats.mean() == 5500us);
+
+    stats.add(1ms);
+    stats.add(1ms);
+    REQUIRE(stats.p99() == 1ms);
+    REQUIRE(stats.mean() == 1ms);
+    REQUIRE(stats.totalFrames() == 8);
+}
+
+TEST_CASE("Hitches are counted in the window and in total", "[frame-stats]")
+{
+    auto stats = tempo::FrameStats{20ms, 3};
+    REQUIRE(stats.hitchThreshold() == 20ms);
+
+    // On the threshold is not a hitch
+    for (auto frameTime : {30ms, 10ms, 20ms, 30ms, 10ms, 10ms}) {
+        stats.add(frameTime);
+    }
+    REQUIRE(stats.windowHitches() == 1);
+    REQUIRE(stats.totalHitches() == 2);
+    REQUIRE(stats.totalFrames() == 6);
+
+    stats.reset();
+    REQUIRE(stats.size() == 0);
+    REQUIRE(stats.windowHitches() == 0);
+    REQUIRE(stats.totalHitches() == 0);
+    REQUIRE(stats.totalFrames() == 0);
+    REQUIRE(stats.p99() == 0ms);
+    REQUIRE(stats.mean() == 0ms);
+    REQUIRE(stats.last() == 0ms);
+
+    stats.add(40ms);
+    REQUIRE(stats.size() == 1);
+    REQUIRE(stats.windowHitches() == 1);
+    REQUIRE(stats.p50() == 40ms);
+}
+
+TEST_CASE("Frame stats print in milliseconds", "[frame-stats]")
+{
+    auto stats = tempo::FrameStats{20ms, 3};
+    stats.add(10ms);
+    stats.add(30ms);
+
+    auto output = std::ostringstream{};
+    output << stats;
+    REQUIRE(output.str() ==
+        "p50 10 ms, p95 30 ms, p99 30 ms, mean 20 ms, 1 hitches in 2 frames");
+}
+
+TEST_CASE("Frame stats need a window", "[frame-stats]")
+{
+    REQUIRE_THROWS_AS(tempo::FrameStats(20ms, 0), std::invalid_argument);
+}
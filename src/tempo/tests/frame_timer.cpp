@@ -0,0 +1,97 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <tempo/frame_timer.hpp>
+
+#include <chrono>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+using Timer = tempo::FrameTimer;
+
+Timer::PacingStats initialStats()
+{
+    auto stats = Timer::PacingStats{};
+    stats.margin = Timer::initialMargin;
+    return stats;
+}
+
+} // namespace
+
+TEST_CASE("The margin grows at once to cover oversleep", "[frame-timer]")
+{
+    auto stats = initialStats();
+    stats.addSleep(800us);
+    REQUIRE(stats.margin == 1000us);
+
+    // A quarter above the oversleep, rounded down to the nanosecond
+    stats.addSleep(1001ns + 1000us);
+    REQUIRE(stats.margin == 1251ns + 1250us);
+
+    stats.addSleep(10ms);
+    REQUIRE(stats.margin == Timer::maxMargin);
+}
+
+TEST_CASE("The margin shrinks slowly after oversleep", "[frame-timer]")
+{
+    auto stats = initialStats();
+    stats.addSleep(1280us);
+    REQUIRE(stats.margin == 1600us);
+
+    stats.addSleep(0us);
+    REQUIRE(stats.margin == 1575us);
+
+    // An oversleep below what the margin shrinks to does not matter
+    auto margin = stats.margin;
+    stats.addSleep(margin / 2);
+    REQUIRE(stats.margin == margin - margin / 64);
+
+    for (int i = 0; i < 1000; i++) {
+        stats.addSleep(0us);
+        REQUIRE(stats.margin >= Timer::minMargin);
+    }
+    REQUIRE(stats.margin == Timer::minMargin);
+
+    stats.addSleep(60us);
+    REQUIRE(stats.margin == 75us);
+}
+
+TEST_CASE("Oversleep is summarized", "[frame-timer]")
+{
+    auto stats = initialStats();
+    REQUIRE(stats.meanOversleep() == 0us);
+
+    stats.addSleep(300us);
+    stats.addSleep(100us);
+    stats.addSleep(200us);
+    REQUIRE(stats.sleeps == 3);
+    REQUIRE(stats.lastOversleep == 200us);
+    REQUIRE(stats.maxOversleep == 300us);
+    REQUIRE(stats.totalOversleep == 600us);
+    REQUIRE(stats.meanOversleep() == 200us);
+}
+
+TEST_CASE("Hybrid pacing does not return early", "[frame-timer]")
+{
+    auto timer = Timer{500, tempo::Pacing::Hybrid};
+    REQUIRE(timer.stats().margin == Timer::initialMargin);
+
+    timer();
+    for (int i = 0; i < 5; i++) {
+        timer.relax();
+        REQUIRE(timer() >= 1);
+    }
+    REQUIRE(timer.stats().frames == 5);
+    REQUIRE(timer.stats().sleeps <= 5);
+    REQUIRE(timer.stats().margin >= Timer::minMargin);
+    REQUIRE(timer.stats().margin <= Timer::maxMargin);
+    REQUIRE(timer.frameStats().totalFrames() >= 5);
+
+    // Only the margin is learned, and kept
+    auto margin = timer.stats().margin;
+    timer.resetStats();
+    REQUIRE(timer.stats().frames == 0);
+    REQUIRE(timer.stats().sleeps == 0);
+    REQUIRE(timer.stats().margin == margin);
+}
@@ -0,0 +1,140 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <tempo/loop.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+using Clock = tempo::FastClock;
+
+bool near(double lhs, double rhs)
+{
+    return std::abs(lhs - rhs) < 1e-9;
+}
+
+// Time that moves only when the test says so
+class FakeTime {
+public:
+    explicit FakeTime(tempo::Loop& loop)
+        : _loop(loop)
+    {
+        _loop.reset(_now);
+    }
+
+    int advance(Clock::duration frameTime)
+    {
+        _now += frameTime;
+        return _loop.advance(_now);
+    }
+
+    [[nodiscard]] Clock::time_point now() const
+    {
+        return _now;
+    }
+
+private:
+    tempo::Loop& _loop;
+    Clock::time_point _now {1s};
+};
+
+} // namespace
+
+TEST_CASE("Steps follow the accumulated time", "[loop]")
+{
+    auto loop = tempo::Loop{100};
+    auto time = FakeTime{loop};
+    REQUIRE(near(loop.delta(), 0.01));
+    REQUIRE(loop.alpha() == 0);
+
+    REQUIRE(time.advance(4ms) == 0);
+    REQUIRE(near(loop.alpha(), 0.4));
+    REQUIRE(near(loop.frameTime(), 0.004));
+
+    REQUIRE(time.advance(7ms) == 1);
+    REQUIRE(near(loop.alpha(), 0.1));
+
+    REQUIRE(time.advance(29ms) == 3);
+    REQUIRE(near(loop.alpha(), 0.0));
+    REQUIRE(near(loop.frameTime(), 0.029));
+
+    REQUIRE(time.advance(0ms) == 0);
+    REQUIRE(loop.frameTime() == 0);
+    REQUIRE(loop.droppedSteps() == 0);
+}
+
+TEST_CASE("Steps beyond the catch-up limit are dropped", "[loop]")
+{
+    auto loop = tempo::Loop{100, 3};
+    auto time = FakeTime{loop};
+
+    REQUIRE(time.advance(30ms) == 3);
+    REQUIRE(loop.droppedSteps() == 0);
+
+    // The fraction of a step is kept, only whole steps are dropped
+    REQUIRE(time.advance(105ms) == 3);
+    REQUIRE(loop.droppedSteps() == 7);
+    REQUIRE(near(loop.alpha(), 0.5));
+
+    REQUIRE(time.advance(5ms) == 1);
+    REQUIRE(loop.droppedSteps() == 7);
+    REQUIRE(near(loop.alpha(), 0.0));
+
+    REQUIRE(time.advance(1s) == 3);
+    REQUIRE(loop.droppedSteps() == 104);
+}
+
+TEST_CASE("Uneven steps neither gain nor lose time", "[loop]")
+{
+    // A 60th of a second is not a whole number of nanoseconds
+    auto loop = tempo::Loop{60};
+    auto time = FakeTime{loop};
+    const auto step = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(loop.delta()));
+
+    auto frameTime = 3ms;
+    auto elapsed = Clock::duration{};
+    int64_t steps = 0;
+    for (int frame = 0; frame < 10'000; frame++) {
+        // Frame times from 3 to 39 ms, some below and some above a step
+        frameTime = frameTime % 37ms + 3ms;
+        elapsed += frameTime;
+        steps += time.advance(frameTime);
+
+        REQUIRE(loop.alpha() >= 0);
+        REQUIRE(loop.alpha() < 1);
+    }
+    REQUIRE(loop.droppedSteps() == 0);
+    REQUIRE(steps == elapsed / step);
+    REQUIRE(near(
+        loop.alpha(),
+        std::chrono::duration<double>(elapsed % step) /
+            std::chrono::duration<double>(step)));
+}
+
+TEST_CASE("Reset drops the accumulated time", "[loop]")
+{
+    auto loop = tempo::Loop{100};
+    auto time = FakeTime{loop};
+    REQUIRE(time.advance(15ms) == 1);
+
+    loop.reset(time.now() + 100ms);
+    REQUIRE(loop.alpha() == 0);
+    REQUIRE(loop.frameTime() == 0);
+
+    // Measured from the reset, not from the last frame
+    REQUIRE(time.advance(106ms) == 0);
+    REQUIRE(near(loop.alpha(), 0.6));
+}
+
+TEST_CASE("Loop rates must be positive", "[loop]")
+{
+    REQUIRE_THROWS_AS(tempo::Loop{0}, std::invalid_argument);
+    REQUIRE_THROWS_AS(tempo::Loop{-60}, std::invalid_argument);
+    REQUIRE_THROWS_AS((tempo::Loop{60, 0}), std::invalid_argument);
+}
@@ -0,0 +1,249 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <tempo/timer_wheel.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr double resolution = 0.001;
+
+// Tick at which the wheel is, while a callback runs
+int64_t currentTick(const tempo::TimerWheel& wheel)
+{
+    return std::llround(wheel.now() / resolution);
+}
+
+void advanceTicks(tempo::TimerWheel& wheel, int64_t ticks)
+{
+    wheel.advance(static_cast<double>(ticks) * resolution);
+}
+
+} // namespace
+
+TEST_CASE("One-shot timers fire once when due", "[timer-wheel]")
+{
+    auto wheel = tempo::TimerWheel{resolution};
+    auto fired = std::vector<int64_t>{};
+    wheel.after(0.005, [&] { fired.push_back(currentTick(wheel)); });
+    REQUIRE(wheel.size() == 1);
+
+    advanceTicks(wheel, 4);
+    REQUIRE(fired.empty());
+    advanceTicks(wheel, 1);
+    REQUIRE(fired == std::vector<int64_t>{5});
+
+    advanceTicks(wheel, 100);
+    REQUIRE(fired.size() == 1);
+    REQUIRE(wheel.empty());
+}
+
+TEST_CASE("Timers fire in order of due time", "[timer-wheel]")
+{
+    auto wheel = tempo::TimerWheel{resolution};
+    auto order = std::vector<int>{};
+    wheel.after(0.030, [&] { order.push_back(3); });
+    wheel.after(0.010, [&] { order.push_back(1); });
+    wheel.after(0.020, [&] { order.push_back(2); });
+
+    wheel.advance(1.0);
+    REQUIRE(order == std::vector<int>{1, 2, 3});
+}
+
+TEST_CASE("Cancelled timers do not fire", "[timer-wheel]")
+{
+    auto wheel = tempo::TimerWheel{resolution};
+    int fired = 0;
+    auto id = wheel.after(0.010, [&] { fired++; });
+    auto other = wheel.after(0.010, [&] { fired += 10; });
+
+    REQUIRE(wheel.contains(id));
+    REQUIRE(wheel.cancel(id));
+    REQUIRE(!wheel.contains(id));
+    REQUIRE(!wheel.cancel(id));
+
+    advanceTicks(wheel, 10);
+    REQUIRE(fired == 10);
+    REQUIRE(!wheel.contains(other));
+    REQUIRE(!wheel.cancel(other));
+}
+
+TEST_CASE("Stale ids do not match reused timers", "[timer-wheel]")
+{
+    auto wheel = tempo::TimerWheel{resolution};
+    auto first = wheel.after(0.001, [] {});
+    advanceTicks(wheel, 1);
+
+    auto second = wheel.after(0.001, [] {});
+    REQUIRE(second.index == first.index);
+    REQUIRE(!wheel.contains(first));
+    REQUIRE(!wheel.cancel(first));
+    REQUIRE(wheel.contains(second));
+}
+
+TEST_CASE("Timers cascade down every level", "[timer-wheel]")
+{
+    // Delays in ticks that land in each of the four levels, and on the
+    // boundaries between them
+    const auto delays = std::vector<int64_t>{
+        1, 255, 256, 257, 65'535, 65'536, 65'537, 300'000,
+        16'777'215, 16'777'216, 16'777'217, 20'000'000};
+
+    auto wheel = tempo::TimerWheel{resolution};
+    auto fired = std::map<int64_t, int64_t>{};
+    for (auto delay : delays) {
+        wheel.after(static_cast<double>(delay) * resolution, [&, delay] {
+            fired[delay] = currentTick(wheel);
+        });
+    }
+
+    // Uneven steps, so that cascades happen inside and at the end of them
+    for (int64_t step = 1; !wheel.empty(); step = step * 3 % 1'000'003) {
+        advanceTicks(wheel, step);
+    }
+    REQUIRE(fired.size() == delays.size());
+    for (auto delay : delays) {
+        REQUIRE(fired.at(delay) == delay);
+    }
+}
+
+TEST_CASE("Callbacks may cancel and add timers", "[timer-wheel]")
+{
+    auto wheel = tempo::TimerWheel{resolution};
+    int fired = 0;
+    auto later = wheel.after(0.006, [&] { fired += 100; });
+    wheel.after(0.005, [&] {
+        fired++;
+        wheel.cancel(later);
+        wheel.after(0.001, [&] { fired += 10; });
+    });
+
+    advanceTicks(wheel, 5);
+    advanceTicks(wheel, 1);
+    REQUIRE(fired == 11);
+    REQUIRE(wheel.empty());
+}
+
+TEST_CASE("Periodic timers fire at multiples of their period",
+    "[timer-wheel]")
+{
+    auto wheel = tempo::TimerWheel{resolution};
+    auto fired = std::vector<int64_t>{};
+    auto id = wheel.every(0.003, [&] { fired.push_back(currentTick(wheel)); });
+
+    advanceTicks(wheel, 10);
+    REQUIRE(fired == std::vector<int64_t>{3, 6, 9});
+
+    // Due several times in one advance
+    advanceTicks(wheel, 6);
+    REQUIRE(fired == std::vector<int64_t>{3, 6, 9, 12, 15});
+
+    REQUIRE(wheel.cancel(id));
+    advanceTicks(wheel, 10);
+    REQUIRE(fired.size() == 5);
+}
+
+TEST_CASE("Periodic timers do not drift", "[timer-wheel]")
+{
+    // A period that is not exact in binary, and one of a tick and a half,
+    // which is due at every tick the half rounds up to
+    SECTION("Whole ticks") {
+        auto wheel = tempo::TimerWheel{resolution};
+        int64_t count = 0;
+        bool exact = true;
+        wheel.every(0.007, [&] {
+            count++;
+            exact = exact && currentTick(wheel) == count * 7;
+        });
+        for (int i = 0; i < 2'000; i++) {
+            advanceTicks(wheel, 997);
+        }
+        REQUIRE(exact);
+        REQUIRE(count == 2'000 * 997 / 7);
+    }
+
+    SECTION("Fractions of a tick") {
+        auto wheel = tempo::TimerWheel{resolution};
+        int64_t count = 0;
+        bool exact = true;
+        wheel.every(0.0015, [&] {
+            count++;
+            exact = exact && currentTick(wheel) == (count * 3 + 1) / 2;
+        });
+        for (int i = 0; i < 1'000'000; i++) {
+            advanceTicks(wheel, 1);
+        }
+        REQUIRE(exact);
+        REQUIRE(count == 1'000'000 * 2 / 3);
+    }
+}
+
+TEST_CASE("Timer wheel matches a brute-force model", "[timer-wheel]")
+{
+    struct Expected {
+        int64_t due = 0;
+        int64_t period = 0;
+    };
+
+    auto random = std::mt19937{42};
+    auto wheel = tempo::TimerWheel{resolution};
+    auto model = std::map<int, Expected>{};
+    auto ids = std::map<int, tempo::TimerId>{};
+    auto fired = std::vector<std::pair<int, int64_t>>{};
+    auto expected = std::vector<std::pair<int, int64_t>>{};
+    int64_t now = 0;
+
+    for (int round = 0; round < 2'000; round++) {
+        const auto delay = static_cast<int64_t>(
+            std::uniform_int_distribution<int64_t>{1, 100'000}(random));
+        const bool periodic = random() % 4 == 0;
+        const int key = round;
+        auto callback = [&, key] {
+            fired.emplace_back(key, currentTick(wheel));
+        };
+        ids[key] = periodic ?
+            wheel.every(static_cast<double>(delay) * resolution, callback) :
+            wheel.after(static_cast<double>(delay) * resolution, callback);
+        model[key] = Expected{now + delay, periodic ? delay : 0};
+
+        if (random() % 5 == 0 && !model.empty()) {
+            auto victim = std::next(model.begin(),
+                static_cast<long>(random() % model.size()));
+            REQUIRE(wheel.cancel(ids.at(victim->first)));
+            model.erase(victim);
+        }
+
+        const auto step = static_cast<int64_t>(random() % 500);
+        for (auto it = model.begin(); it != model.end(); ) {
+            auto& timer = it->second;
+            while (timer.due <= now + step) {
+                expected.emplace_back(it->first, timer.due);
+                if (timer.period == 0) {
+                    break;
+                }
+                timer.due += timer.period;
+            }
+            if (timer.period == 0 && timer.due <= now + step) {
+                it = model.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        advanceTicks(wheel, step);
+        now += step;
+
+        std::sort(fired.begin(), fired.end());
+        std::sort(expected.begin(), expected.end());
+        REQUIRE(fired == expected);
+        REQUIRE(wheel.size() == model.size());
+        fired.clear();
+        expected.clear();
+    }
+}
@@ -0,0 +1,315 @@
+#include <tempo/timer_wheel.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+namespace tempo {
+
+namespace {
+
+// Tolerance for due times that land on a tick, give or take rounding
+constexpr double tickEpsilon = 1e-9;
+
+constexpr double fractionScale = 4294967296.0;
+
+} // namespace
+
+bool TimerWheel::isPeriodic(const Timer& timer)
+{
+    return timer.period.whole != 0 || timer.period.fraction != 0;
+}
+
+TimerWheel::Ticks TimerWheel::addTicks(Ticks lhs, Ticks rhs)
+{
+    const auto fraction = uint64_t{lhs.fraction} + rhs.fraction;
+    return Ticks{
+        .whole = lhs.whole + rhs.whole + (fraction >> 32U),
+        .fraction = static_cast<uint32_t>(fraction),
+    };
+}
+
+uint64_t TimerWheel::expiryTick(Ticks due)
+{
+    return due.whole + (due.fraction != 0 ? 1 : 0);
+}
+
+TimerWheel::TimerWheel(double resolution)
+    : _resolution(resolution)
+{
+    if (!(resolution > 0)) {
+        throw std::invalid_argument{
+            "tempo::TimerWheel: resolution must be positive"};
+    }
+    _lists.fill(none);
+}
+
+TimerId TimerWheel::after(double delay, Callback callback)
+{
+    return add(now() + delay, 0.0, std::move(callback));
+}
+
+TimerId TimerWheel::every(double period, Callback callback)
+{
+    if (!(period > 0)) {
+        throw std::invalid_argument{
+            "tempo::TimerWheel: period must be positive"};
+    }
+    return add(now() + period, period, std::move(callback));
+}
+
+bool TimerWheel::cancel(TimerId id)
+{
+    if (!contains(id)) {
+        return false;
+    }
+    unlink(id.index);
+    release(id.index);
+    return true;
+}
+
+bool TimerWheel::contains(TimerId id) const
+{
+    return id.index < _timers.size() &&
+        _timers[id.index].generation == id.generation &&
+        _timers[id.index].list != none;
+}
+
+void TimerWheel::advance(double delta)
+{
+    _remainder += delta;
+    auto ticks = static_cast<uint64_t>(
+        std::max(0.0, std::floor(_remainder / _resolution + tickEpsilon)));
+    _remainder = std::max(
+        0.0, _remainder - static_cast<double>(ticks) * _resolution);
+
+    const auto end = _now + ticks;
+    while (_now < end) {
+        skipIdleTicks(end);
+        if (_now == end) {
+            break;
+        }
+
+        _now++;
+        if ((_now & (slotCount - 1)) == 0) {
+            // Move timers down from each level whose slot has just changed,
+            // the highest first, as they may land in lower slots that also
+            // have to be moved down now
+            size_t top = 1;
+            while (top + 1 < levelCount &&
+                    (_now & ((uint64_t{1} << (slotBits * (top + 1))) - 1)) ==
+                        0) {
+                top++;
+            }
+            for (size_t level = top; level >= 1; level--) {
+                cascade(level);
+            }
+        }
+        fire();
+    }
+}
+
+double TimerWheel::now() const
+{
+    return static_cast<double>(_now) * _resolution + _remainder;
+}
+
+double TimerWheel::resolution() const
+{
+    return _resolution;
+}
+
+size_t TimerWheel::size() const
+{
+    return _size;
+}
+
+bool TimerWheel::empty() const
+{
+    return _size == 0;
+}
+
+void TimerWheel::clear()
+{
+    for (uint32_t index = 0; index < _timers.size(); index++) {
+        if (_timers[index].list != none) {
+            unlink(index);
+            release(index);
+        }
+    }
+}
+
+TimerId TimerWheel::add(double due, double period, Callback callback)
+{
+    uint32_t index = 0;
+    if (_free.empty()) {
+        index = static_cast<uint32_t>(_timers.size());
+        _timers.emplace_back();
+    } else {
+        index = _free.back();
+        _free.pop_back();
+    }
+
+    auto& timer = _timers[index];
+    timer.callback = std::move(callback);
+    timer.due = toTicks(due);
+    timer.period = toTicks(period);
+    timer.expiry = std::max(expiryTick(timer.due), _now + 1);
+    _size++;
+
+    place(index);
+    return TimerId{.index = index, .generation = timer.generation};
+}
+
+TimerWheel::Ticks TimerWheel::toTicks(double seconds) const
+{
+    // Rounding to the nearest fraction also absorbs the error of dividing by
+    // the resolution, so that whole numbers of ticks come out exact
+    const auto ticks = std::max(0.0, seconds / _resolution);
+    auto whole = std::floor(ticks);
+    auto fraction = std::round((ticks - whole) * fractionScale);
+    if (fraction >= fractionScale) {
+        whole += 1;
+        fraction = 0;
+    }
+    return Ticks{
+        .whole = static_cast<uint64_t>(whole),
+        .fraction = static_cast<uint32_t>(fraction),
+    };
+}
+
+void TimerWheel::place(uint32_t index)
+{
+    auto expiry = _timers[index].expiry;
+    if (expiry <= _now) {
+        link(index, _now & (slotCount - 1));
+        return;
+    }
+
+    for (size_t level = 0; level < levelCount; level++) {
+        auto shift = slotBits * level;
+        if ((expiry >> shift) - (_now >> shift) < slotCount) {
+            link(index,
+                level * slotCount + ((expiry >> shift) & (slotCount - 1)));
+            return;
+        }
+    }
+
+    // Too far ahead: park in the last slot of the top level, and place
+    // again when it comes round
+    auto shift = slotBits * (levelCount - 1);
+    link(index, (levelCount - 1) * slotCount +
+        (((_now >> shift) + slotCount - 1) & (slotCount - 1)));
+}
+
+void TimerWheel::skipIdleTicks(uint64_t end)
+{
+    // Nothing happens until the next tick that moves timers down from the
+    // lowest level that has any
+    size_t level = 0;
+    while (level < levelCount && _levelSizes.at(level) == 0) {
+        level++;
+    }
+    if (level == 0) {
+        return;
+    }
+    if (level == levelCount) {
+        _now = end;
+        return;
+    }
+
+    auto shift = slotBits * level;
+    auto next = ((_now >> shift) + 1) << shift;
+    _now = std::max(_now, std::min(end, next - 1));
+}
+
+void TimerWheel::link(uint32_t index, size_t list)
+{
+    _levelSizes.at(list / slotCount)++;
+    auto& timer = _timers[index];
+    timer.list = static_cast<uint32_t>(list);
+    timer.prev = none;
+    timer.next = _lists[list];
+    if (timer.next != none) {
+        _timers[timer.next].prev = index;
+    }
+    _lists[list] = index;
+}
+
+void TimerWheel::unlink(uint32_t index)
+{
+    auto& timer = _timers[index];
+    _levelSizes.at(timer.list / slotCount)--;
+    if (timer.prev != none) {
+        _timers[timer.prev].next = timer.next;
+    } else {
+        _lists[timer.list] = timer.next;
+    }
+    if (timer.next != none) {
+        _timers[timer.next].prev = timer.prev;
+    }
+    timer.list = none;
+    timer.prev = none;
+    timer.next = none;
+}
+
+void TimerWheel::release(uint32_t index)
+{
+    auto& timer = _timers[index];
+    timer.callback = {};
+    timer.generation++;
+    _free.push_back(index);
+    _size--;
+}
+
+void TimerWheel::cascade(size_t level)
+{
+    auto slot = (_now >> (slotBits * level)) & (slotCount - 1);
+    auto list = level * slotCount + slot;
+    while (_lists[list] != none) {
+        auto index = _lists[list];
+        unlink(index);
+        place(index);
+    }
+}
+
+void TimerWheel::fire()
+{
+    auto slot = _now & (slotCount - 1);
+    while (_lists[slot] != none) {
+        auto index = _lists[slot];
+        unlink(index);
+        link(index, firingList);
+    }
+
+    // Callbacks may add and cancel timers, including their own, so no
+    // reference to a timer is kept while one runs
+    while (_lists[firingList] != none) {
+        auto index = _lists[firingList];
+        unlink(index);
+
+        auto callback = std::move(_timers[index].callback);
+        auto generation = _timers[index].generation;
+        if (auto& timer = _timers[index]; isPeriodic(timer)) {
+            timer.due = addTicks(timer.due, timer.period);
+            timer.expiry = expiryTick(timer.due);
+            if (timer.expiry <= _now) {
+                link(index, firingList);
+            } else {
+                place(index);
+            }
+        } else {
+            release(index);
+        }
+
+        callback();
+
+        auto& timer = _timers[index];
+        if (timer.generation == generation && timer.list != none) {
+            timer.callback = std::move(callback);
+        }
+    }
+}
+
+} // namespace tempo